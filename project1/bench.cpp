@@ -0,0 +1,291 @@
+/* Benchmarks of the simulators, built with make bench and written to
+stdout as JSON so that runs can be compared over time:
+- whole runs of every algorithm on synthetic workloads, as ns per
+  simulated ms and ns per scheduling event (a burst becoming ready or a
+  context switch), while the number of processes, the number of CPU
+  bursts per process, t_cs and t_slice grow one at a time;
+- the steps the single CPU simulators are made of (check_arrival,
+  do_waiting, do_blocking, perform_add_to_ready_queue and
+  context_switch), as ns per call (per process queued for
+  perform_add_to_ready_queue).
+Every figure is the best of a number of repetitions.
+
+Usage: ./bench [--repetitions=N] [--calls=N]
+ */
+#include "schedule_algorithm.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <math.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsed_ns(const bench_clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(bench_clock::now() - start)
+      .count();
+}
+
+// Exponential with parameter lambda, at most threshold, at least 1
+static int draw(const double lambda, const int threshold) {
+  double value;
+  do {
+    value = ceil(-log(drand48()) / lambda);
+  } while (value > threshold);
+  return std::max(1, (int)value);
+}
+
+/* n processes of cpu_bursts CPU bursts each, drawn like the assignment
+workloads (lambda 0.01, upper bound 1000) but with a fixed number of
+bursts.*/
+static std::shared_ptr<const workload>
+synthetic_workload(const int n, const int cpu_bursts) {
+  const double lambda = 0.01;
+  const int threshold = 1000;
+  srand48(n * 1000 + cpu_bursts);
+  std::shared_ptr<workload> jobs = std::make_shared<workload>();
+  jobs->reserve(n, (size_t)n * (2 * cpu_bursts - 1));
+  std::vector<int> bursts(2 * cpu_bursts - 1);
+  for (int i = 0; i < n; ++i) {
+    const int arrival_time = draw(lambda, threshold) - 1;
+    for (auto &b : bursts) {
+      b = draw(lambda, threshold);
+    }
+    jobs->add(arrival_time, bursts.data(), bursts.size());
+  }
+  return jobs;
+}
+
+// One point of the whole run benchmarks
+struct run_config {
+  int n;
+  int cpu_bursts;
+  int t_cs;
+  int t_slice;
+};
+
+static void bench_run(const std::string &algorithm, const run_config &config,
+                      const int repetitions, const bool first) {
+  std::shared_ptr<const workload> jobs =
+      synthetic_workload(config.n, config.cpu_bursts);
+  schedule_parameters parameters;
+  parameters.t_cs = config.t_cs;
+  parameters.lambda = 0.01;
+  parameters.alpha = 0.5;
+  parameters.t_slice = config.t_slice;
+  parameters.rr_add = false;
+  parameters.cores = 0;
+  parameters.migration_cost = 0;
+  parameters.balance = STEAL_BALANCE;
+  parameters.mlfq_boost = 1000;
+  parameters.cfs_latency = 0;
+  parameters.cfs_granularity = 0;
+  parameters.lottery_seed = 1;
+  parameters.switch_resume = -1;
+  parameters.switch_cache = 0;
+  parameters.switch_cache_decay = 100;
+  parameters.predictor_window = 5;
+  parameters.tau0 = 0;
+  double best = 0;
+  sim_time simulated = 0;
+  int64_t events = 0;
+  for (int r = 0; r < repetitions; ++r) {
+    std::unique_ptr<schedule_algorithm> s(
+        make_scheduler(algorithm, jobs, parameters));
+    s->set_output(NULL);
+    const bench_clock::time_point start = bench_clock::now();
+    s->run();
+    const double ns = elapsed_ns(start);
+    if (r == 0 || ns < best) {
+      best = ns;
+    }
+    simulated = s->get_time();
+    events = jobs->get_n_CPU_bursts() + s->get_stats().context_switches;
+  }
+  std::cout << (first ? "" : ",\n") << "    {\"algorithm\": \"" << algorithm
+            << "\", \"processes\": " << config.n
+            << ", \"cpu_bursts\": " << config.cpu_bursts
+            << ", \"t_cs\": " << config.t_cs
+            << ", \"t_slice\": " << config.t_slice
+            << ", \"simulated_ms\": " << simulated
+            << ", \"events\": " << events << ", \"ns\": " << best
+            << ", \"ns_per_simulated_ms\": "
+            << best / std::max<sim_time>(simulated, 1)
+            << ", \"ns_per_event\": " << best / std::max<int64_t>(events, 1)
+            << "}";
+}
+
+// The steps measured on their own, in the order hot_path measures them
+static const char *const hot_path_names[] = {
+    "check_arrival", "do_waiting", "do_blocking",
+    "perform_add_to_ready_queue", "context_switch"};
+static const int n_hot_paths = 5;
+
+/* Gives the benchmark access to the steps a simulator is made of. The
+state they run on is set up by hand, between the steps of a run rather
+than as a run would leave it.*/
+template <class scheduler> class hot_path : public scheduler {
+public:
+  using scheduler::scheduler;
+  // Time calls calls of each step and store the ns per call in ns
+  void measure(const int calls, double ns[n_hot_paths]) {
+    std::vector<process> &processes = this->processes;
+    // After every arrival, with every process blocked on a long I/O
+    for (auto &p : processes) {
+      this->time = std::max<sim_time>(this->time, p.get_arrival_time() + 1);
+    }
+    for (auto p = processes.begin(); p != processes.end(); ++p) {
+      this->blocked.add(p, this->io_clock + ((sim_time)1 << 40));
+    }
+    bench_clock::time_point start = bench_clock::now();
+    for (int i = 0; i < calls; ++i) {
+      this->check_arrival();
+    }
+    ns[0] = elapsed_ns(start) / calls;
+    // Idle CPU and one process waiting, which takes both branches
+    this->enqueue(processes.begin());
+    start = bench_clock::now();
+    for (int i = 0; i < calls; ++i) {
+      this->do_waiting();
+    }
+    ns[1] = elapsed_ns(start) / calls;
+    start = bench_clock::now();
+    for (int i = 0; i < calls; ++i) {
+      this->do_blocking();
+    }
+    ns[2] = elapsed_ns(start) / calls;
+    this->dequeue();
+    // Every process becomes ready at once; ns per process added
+    double total = 0;
+    const int rounds = std::max<int>(1, calls / processes.size());
+    for (int r = 0; r < rounds; ++r) {
+      for (auto p = processes.begin(); p != processes.end(); ++p) {
+        this->prepare_add_to_ready_queue(p);
+      }
+      start = bench_clock::now();
+      this->perform_add_to_ready_queue();
+      total += elapsed_ns(start);
+      // Through dequeue, which also empties what the policy keeps aside
+      while (!this->ready_queue->empty()) {
+        this->dequeue();
+      }
+    }
+    ns[3] = total / ((double)rounds * processes.size());
+    // Switch a process in and back out; ns per switch
+    const int switches = std::max(1, calls / std::max(1, this->t_cs));
+    start = bench_clock::now();
+    for (int i = 0; i < switches; ++i) {
+      this->enqueue(processes.begin());
+      this->context_switch(this->ready_queue->front());
+      this->context_switch(processes.end());
+      // The switched out process is only queued by the next step
+      this->pre_ready_queue.clear();
+    }
+    ns[4] = elapsed_ns(start) / (2.0 * switches);
+  }
+};
+
+template <class scheduler>
+static void bench_hot_paths(const std::string &algorithm,
+                            hot_path<scheduler> &s, const int n,
+                            const int calls, const int repetitions,
+                            bool &first) {
+  double best[n_hot_paths];
+  for (int r = 0; r < repetitions; ++r) {
+    double ns[n_hot_paths];
+    s.measure(calls, ns);
+    for (int i = 0; i < n_hot_paths; ++i) {
+      if (r == 0 || ns[i] < best[i]) {
+        best[i] = ns[i];
+      }
+    }
+  }
+  for (int i = 0; i < n_hot_paths; ++i) {
+    std::cout << (first ? "" : ",\n") << "    {\"algorithm\": \""
+              << algorithm << "\", \"function\": \"" << hot_path_names[i]
+              << "\", \"processes\": " << n << ", \"ns_per_call\": "
+              << best[i] << "}";
+    first = false;
+  }
+}
+
+void usage() {
+  std::cerr << "Usage: ./bench [--repetitions=N] [--calls=N]\n";
+}
+
+int main(int argc, char const *argv[]) {
+  int repetitions = 3;
+  int calls = 1000000;
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--repetitions=", 14) == 0) {
+      repetitions = atoi(argv[i] + 14);
+    } else if (strncmp(argv[i], "--calls=", 8) == 0) {
+      calls = atoi(argv[i] + 8);
+    } else {
+      usage();
+      return 1;
+    }
+  }
+  if (repetitions <= 0 || calls <= 0) {
+    usage();
+    return 1;
+  }
+  const std::vector<std::string> algorithms = {
+      "SJF", "SRT", "FCFS", "RR", "MLFQ", "CFS", "STRIDE", "LOTTERY"};
+  // Grow one setting at a time from the first point
+  const std::vector<run_config> configs = {
+      {32, 20, 8, 100},  {8, 20, 8, 100},  {128, 20, 8, 100},
+      {512, 20, 8, 100}, {32, 5, 8, 100},  {32, 80, 8, 100},
+      {32, 320, 8, 100}, {32, 20, 4, 100}, {32, 20, 32, 100},
+      {32, 20, 8, 25},   {32, 20, 8, 400}};
+  std::cout << "{\n  \"repetitions\": " << repetitions
+            << ",\n  \"calls\": " << calls << ",\n  \"runs\": [\n";
+  bool first = true;
+  for (auto &config : configs) {
+    for (auto &algorithm : algorithms) {
+      bench_run(algorithm, config, repetitions, first);
+      first = false;
+    }
+  }
+  std::cout << "\n  ],\n  \"hot_paths\": [\n";
+  first = true;
+  const int n = 128;
+  const int t_cs = 8;
+  std::shared_ptr<const workload> jobs = synthetic_workload(n, 20);
+  {
+    hot_path<SJF_scheduling> s(jobs, t_cs, 0.01, 0.5);
+    bench_hot_paths("SJF", s, n, calls, repetitions, first);
+  }
+  {
+    hot_path<SRT_scheduling> s(jobs, t_cs, 0.01, 0.5);
+    bench_hot_paths("SRT", s, n, calls, repetitions, first);
+  }
+  {
+    hot_path<FCFS_scheduling> s(jobs, t_cs);
+    bench_hot_paths("FCFS", s, n, calls, repetitions, first);
+  }
+  {
+    hot_path<RR_scheduling> s(jobs, t_cs, 100, false);
+    bench_hot_paths("RR", s, n, calls, repetitions, first);
+  }
+  {
+    hot_path<MLFQ_scheduling> s(jobs, t_cs, {100, 200, 400}, 1000);
+    bench_hot_paths("MLFQ", s, n, calls, repetitions, first);
+  }
+  {
+    hot_path<CFS_scheduling> s(jobs, t_cs, 100, 12, {});
+    bench_hot_paths("CFS", s, n, calls, repetitions, first);
+  }
+  {
+    hot_path<stride_scheduling> s(jobs, t_cs, 100, {});
+    bench_hot_paths("STRIDE", s, n, calls, repetitions, first);
+  }
+  {
+    hot_path<lottery_scheduling> s(jobs, t_cs, 100, {}, 1);
+    bench_hot_paths("LOTTERY", s, n, calls, repetitions, first);
+  }
+  std::cout << "\n  ]\n}\n";
+  return 0;
+}
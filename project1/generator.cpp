@@ -0,0 +1,187 @@
+#include "generator.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <assert.h>
+#include <limits>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+/* Draw the bursts of one process the way process_generator does: 1 to
+100 CPU bursts with I/O bursts in between, all exponential with parameter
+lambda and drawn again above threshold.*/
+static void draw_bursts(unsigned short state[3], const double lambda,
+                        const int threshold,
+                        std::vector<int> &time_sequence) {
+  double r = erand48(state);
+  int n_cpu_bursts = (int)(r * 100) + 1;
+  time_sequence.resize(n_cpu_bursts * 2 - 1);
+  for (int j = 0; j < n_cpu_bursts; ++j) {
+    r = erand48(state);
+    int cpu_time = threshold + 1;
+    while (cpu_time > threshold) {
+      cpu_time = (int)ceil(-log(r) / lambda);
+      if (cpu_time > threshold)
+        r = erand48(state);
+    }
+    time_sequence[2 * j] = cpu_time;
+    if (j == n_cpu_bursts - 1)
+      break;
+    r = erand48(state);
+    int io_time = threshold + 1;
+    while (io_time > threshold) {
+      io_time = (int)ceil(-log(r) / lambda);
+      if (io_time > threshold)
+        r = erand48(state);
+    }
+    time_sequence[2 * j + 1] = io_time;
+  }
+}
+
+workload process_generator(const int s, const double lambda,
+                           const int threshold, const int n) {
+  /* Initialize the random number table with given seed. This is the
+  state srand48(s) sets up, but kept here so that several workloads can
+  be generated at once from different threads.*/
+  unsigned short state[3] = {0x330E, (unsigned short)(s & 0xFFFF),
+                             (unsigned short)((s >> 16) & 0xFFFF)};
+  // Initialize the table for storing processes. About 100 bursts each
+  workload processes;
+  processes.reserve(n, (size_t)n * 100);
+  // Bursts of the process being generated, reused for all of them
+  std::vector<int> time_sequence;
+  assert(n > 0);
+  for (int i = 0; i < n; ++i) {
+    double r = erand48(state);
+    int arrival_time = (int)(-log(r) / lambda);
+    if (arrival_time > threshold) {
+      --i;
+      continue;
+    }
+    draw_bursts(state, lambda, threshold, time_sequence);
+    processes.add(arrival_time, time_sequence.data(), time_sequence.size());
+  }
+  return processes;
+}
+
+generator_stream::generator_stream(const int s, const double lambda,
+                                   const int threshold, const int n,
+                                   const double gap)
+    : state{0x330E, (unsigned short)(s & 0xFFFF),
+            (unsigned short)((s >> 16) & 0xFFFF)},
+      lambda(lambda), threshold(threshold), remaining(n), gap(gap),
+      clock(0) {}
+
+bool generator_stream::next(int &arrival_time, std::vector<int> &bursts) {
+  if (remaining == 0) {
+    return false;
+  }
+  clock += (int64_t)(-log(erand48(state)) * gap);
+  if (clock > std::numeric_limits<int>::max()) {
+    error = "runs past the longest arrival time";
+    return false;
+  }
+  --remaining;
+  arrival_time = clock;
+  draw_bursts(state, lambda, threshold, bursts);
+  return true;
+}
+
+// SplitMix64 output function
+static inline uint64_t mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+static const uint64_t golden_gamma = 0x9e3779b97f4a7c15ULL;
+
+/* Counter based random numbers: the i-th number of a stream is a hash of
+the stream key and i, so any number can be drawn without the ones before
+it. Every process has its own stream.*/
+class random_stream {
+public:
+  random_stream(const uint64_t seed, const uint64_t stream)
+      : key(mix(seed ^ mix((stream + 1) * golden_gamma))) {}
+  uint64_t bits(const uint64_t i) const {
+    return mix(key + (i + 1) * golden_gamma);
+  };
+  // Uniform in [0, 1)
+  double uniform(const uint64_t i) const {
+    return (bits(i) >> 11) * 0x1.0p-53;
+  };
+  // Uniform in (0, 1]
+  double uniform_open(const uint64_t i) const {
+    return ((bits(i) >> 11) + 1) * 0x1.0p-53;
+  };
+
+private:
+  const uint64_t key;
+};
+
+/* Exponential with parameter lambda truncated to at most limit, drawn by
+inverting the truncated CDF instead of drawing again: with
+mass = 1 - exp(-lambda * limit) and v in (0, 1], the result falls in
+[0, limit] up to rounding, so callers clamp it.*/
+static inline double truncated_exponential(const double v,
+                                           const double lambda,
+                                           const double mass) {
+  return -log(1 - v * mass) / lambda;
+}
+
+workload counter_generator(const int s, const double lambda,
+                           const int threshold, const int n,
+                           const unsigned int threads) {
+  assert(n > 0);
+  // Positions 0 and 1 of a stream give the arrival and the number of
+  // bursts, position 2 + j burst j
+  std::vector<int> arrival_times(n);
+  std::vector<uint32_t> n_bursts(n);
+  // Arrival times are rounded down, so anything below threshold + 1 is kept
+  const double arrival_mass = -expm1(-lambda * (threshold + 1.0));
+  const double burst_mass = -expm1(-lambda * (double)threshold);
+  for (int i = 0; i < n; ++i) {
+    random_stream stream(s, i);
+    const double arrival =
+        truncated_exponential(stream.uniform_open(0), lambda, arrival_mass);
+    arrival_times[i] = std::min((int)arrival, threshold);
+    const int n_cpu_bursts = (int)(stream.uniform(1) * 100) + 1;
+    n_bursts[i] = n_cpu_bursts * 2 - 1;
+  }
+  workload processes;
+  processes.layout(arrival_times, n_bursts);
+
+  // Fill in the bursts of blocks of processes in parallel
+  const int block = 256;
+  auto fill = [&](const int first, const int last) {
+    std::vector<double> v;
+    for (int i = first; i < last; ++i) {
+      random_stream stream(s, i);
+      int *bursts = processes.get_bursts_to_fill(i);
+      v.resize(n_bursts[i]);
+      for (uint32_t j = 0; j < n_bursts[i]; ++j) {
+        v[j] = stream.uniform_open(2 + j);
+      }
+      // Kept apart from the drawing so that it can be vectorized
+      for (uint32_t j = 0; j < n_bursts[i]; ++j) {
+        v[j] = ceil(truncated_exponential(v[j], lambda, burst_mass));
+      }
+      for (uint32_t j = 0; j < n_bursts[i]; ++j) {
+        bursts[j] = std::max(1, std::min((int)v[j], threshold));
+      }
+    }
+  };
+  if (threads == 1 || n <= block) {
+    fill(0, n);
+  } else {
+    thread_pool pool(threads);
+    for (int first = 0; first < n; first += block) {
+      pool.submit([&fill, first, n, block] {
+        fill(first, std::min(first + block, n));
+      });
+    }
+    pool.wait();
+  }
+  processes.count_CPU_time();
+  return processes;
+}
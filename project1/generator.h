@@ -0,0 +1,49 @@
+/* Random workload generation for the simulators.
+ */
+#ifndef GENERATOR
+#define GENERATOR
+
+#include "stream.h"
+#include "workload.h"
+
+/* Generate n processes from seed s. Arrival times and burst times are
+exponentially distributed with parameter lambda; values above threshold
+are drawn again. The same seed always gives the same processes.*/
+workload process_generator(const int s, const double lambda,
+                           const int threshold, const int n);
+
+/* Same distributions as process_generator, drawn from a counter based
+random stream per process so that processes are generated in parallel on
+the given number of threads (0 for one per hardware thread). The result
+only depends on the arguments, not on the number of threads, but differs
+from the process_generator sequence.*/
+workload counter_generator(const int s, const double lambda,
+                           const int threshold, const int n,
+                           const unsigned int threads);
+
+/* Processes of a streamed run (see stream.h), generated one at a time
+from seed s: bursts as in process_generator, but arrivals a Poisson
+process, each an exponential gap of gap ms on average after the one
+before, so that a run can go on for as long as wanted. n processes in
+all.*/
+class generator_stream : public process_stream {
+public:
+  generator_stream(const int s, const double lambda, const int threshold,
+                   const int n, const double gap);
+  bool next(int &arrival_time, std::vector<int> &bursts);
+
+private:
+  unsigned short state[3];
+  const double lambda;
+  const int threshold;
+  // Processes left to generate
+  int remaining;
+  const double gap;
+  // Arrival time of the last process
+  int64_t clock;
+};
+
+// Which generator to build workloads with
+enum generator_kind { DRAND48_GENERATOR, COUNTER_GENERATOR };
+
+#endif
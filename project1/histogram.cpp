@@ -0,0 +1,67 @@
+#include "histogram.h"
+#include <algorithm>
+#include <climits>
+#include <math.h>
+
+latency_histogram::latency_histogram()
+    : counts(index(INT64_MAX) + 1, 0), count(0), sum(0), max(0) {}
+
+const int64_t latency_histogram::percentile(const double percent) const {
+  if (count == 0) {
+    return 0;
+  }
+  // Rank of the value asked for, counting from 1
+  const uint64_t rank =
+      std::max<uint64_t>(1, (uint64_t)ceil(percent / 100 * count));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return std::min(highest_in_bucket(i), max);
+    }
+  }
+  return max;
+}
+
+int64_t latency_histogram::highest_in_bucket(const size_t i) {
+  if ((int64_t)i < 2 * sub_buckets) {
+    return i;
+  }
+  const int shift = i / sub_buckets - 1;
+  const int64_t first = (int64_t)(i - shift * sub_buckets) << shift;
+  return first + ((int64_t)1 << shift) - 1;
+}
+
+void latency_histogram::save(snapshot_writer &w) const {
+  std::vector<uint32_t> buckets;
+  std::vector<uint64_t> bucket_counts;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    if (counts[i] != 0) {
+      buckets.push_back(i);
+      bucket_counts.push_back(counts[i]);
+    }
+  }
+  w.put_vector(buckets);
+  w.put_vector(bucket_counts);
+  w.put(count);
+  w.put(sum);
+  w.put(max);
+}
+
+bool latency_histogram::restore(snapshot_reader &r) {
+  std::vector<uint32_t> buckets;
+  std::vector<uint64_t> bucket_counts;
+  if (!r.get_vector(buckets) || !r.get_vector(bucket_counts) ||
+      buckets.size() != bucket_counts.size() || !r.get(count) ||
+      !r.get(sum) || !r.get(max)) {
+    return false;
+  }
+  std::fill(counts.begin(), counts.end(), 0);
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    if (buckets[i] >= counts.size()) {
+      return false;
+    }
+    counts[buckets[i]] = bucket_counts[i];
+  }
+  return true;
+}
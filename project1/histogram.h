@@ -0,0 +1,55 @@
+/* Log-linear histogram of non-negative integer values, in the style of
+HdrHistogram: values below 256 have a bucket each, and every power of two
+above that is split into 128 buckets, so a value is known to within 1/128
+(under 1%). The buckets are allocated once; recording a value is a few
+integer operations and never allocates.
+ */
+#ifndef HISTOGRAM
+#define HISTOGRAM
+
+#include "snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class latency_histogram {
+public:
+  latency_histogram();
+  void record(const int64_t value) {
+    ++counts[index(value)];
+    ++count;
+    sum += value;
+    if (value > max) {
+      max = value;
+    }
+  };
+  const int64_t get_count() const { return count; };
+  const int64_t get_max() const { return max; };
+  const double get_mean() const { return count ? (double)sum / count : 0; };
+  /* Smallest value that percent of the recorded values are at or below,
+  rounded up to the end of its bucket. 0 when nothing was recorded.*/
+  const int64_t percentile(const double percent) const;
+  // Checkpoints: only the buckets that are not empty are written
+  void save(snapshot_writer &) const;
+  bool restore(snapshot_reader &);
+
+private:
+  static const int sub_bits = 7;
+  static const int64_t sub_buckets = 1 << sub_bits;
+  // Bucket of value, see the top of this file
+  static size_t index(const int64_t value) {
+    if (value < 2 * sub_buckets) {
+      return value;
+    }
+    const int shift = 63 - __builtin_clzll(value) - sub_bits;
+    return shift * sub_buckets + (value >> shift);
+  };
+  // Largest value that falls in bucket i
+  static int64_t highest_in_bucket(const size_t i);
+  std::vector<uint64_t> counts;
+  int64_t count;
+  int64_t sum;
+  int64_t max;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "io_timer.h"
+#include <algorithm>
+
+io_timer::io_timer(std::vector<process> &p) : base(p.begin()) {
+  // A process is blocked at most once at a time
+  heap.reserve(p.size());
+}
+
+void io_timer::add(process_ptr p, sim_time wake) {
+  entry e;
+  e.wake = wake;
+  e.process = p - base;
+  heap.push_back(e);
+  std::push_heap(heap.begin(), heap.end(), later);
+}
+
+process_ptr io_timer::pop() {
+  std::pop_heap(heap.begin(), heap.end(), later);
+  process_ptr p = base + heap.back().process;
+  heap.pop_back();
+  return p;
+}
+
+void io_timer::snapshot(std::vector<sim_time> &wakes,
+                        std::vector<process_ptr> &blocked) const {
+  std::vector<entry> sorted(heap);
+  std::sort(sorted.begin(), sorted.end(),
+            [](const entry &a, const entry &b) { return later(b, a); });
+  wakes.clear();
+  blocked.clear();
+  for (auto &e : sorted) {
+    wakes.push_back(e.wake);
+    blocked.push_back(base + e.process);
+  }
+}
@@ -0,0 +1,43 @@
+/* Processes blocked on I/O, ordered by the I/O tick on which their
+burst completes. A blocked process is not touched until it wakes up.
+The heap holds processes by their 32-bit position in the process vector
+and has room for all of them, so blocking never allocates.
+ */
+#ifndef IO_TIMER
+#define IO_TIMER
+
+#include "process.h"
+#include <vector>
+
+class io_timer {
+public:
+  // For the processes of p, which must not move afterwards
+  io_timer(std::vector<process> &p);
+  // Block p until the I/O clock reaches wake
+  void add(process_ptr p, sim_time wake);
+  bool empty() const { return heap.empty(); };
+  size_t size() const { return heap.size(); };
+  // I/O tick of the earliest completion. Must not be empty
+  sim_time next() const { return heap.front().wake; };
+  // Remove the earliest completion and return its process
+  process_ptr pop();
+  // Unblock every process
+  void clear() { heap.clear(); };
+  // Copy the completions, earliest first, into the vectors
+  void snapshot(std::vector<sim_time> &wakes,
+                std::vector<process_ptr> &blocked) const;
+
+private:
+  struct entry {
+    sim_time wake;
+    uint32_t process;
+  };
+  // Whether a completes after b, ties by position, for a heap earliest first
+  static bool later(const entry &a, const entry &b) {
+    return a.wake > b.wake || (a.wake == b.wake && a.process > b.process);
+  };
+  process_ptr base;
+  std::vector<entry> heap;
+};
+
+#endif
@@ -1,13 +1,144 @@
+#include "generator.h"
 #include "process.h"
 #include "schedule_algorithm.h"
+#include "sweep.h"
+#include "thread_pool.h"
 #include <assert.h>
 #include <cstring>
 #include <fstream>
+#include <iterator>
 #include <math.h>
+#include <memory>
+#include <sstream>
+#include <string>
 #include <vector>
 
-std::vector<process> process_generator(const int, const double, const int,
-                                       const int);
+// Parse "a,b,c" into values. Returns false if it is not such a list
+static bool parse_list(const char *text, std::vector<int> &values) {
+  std::stringstream list(text);
+  std::string item;
+  values.clear();
+  while (std::getline(list, item, ',')) {
+    char *end;
+    values.push_back(strtol(item.c_str(), &end, 10));
+    if (item.empty() || *end != '\0') {
+      return false;
+    }
+  }
+  return !values.empty();
+}
+
+// Read or write the whole of a binary file
+static bool read_file(const std::string &path, std::vector<char> &data) {
+  std::ifstream file(path, std::ios::binary);
+  data.assign(std::istreambuf_iterator<char>(file),
+              std::istreambuf_iterator<char>());
+  return !file.bad() && file.is_open();
+}
+
+static bool write_file(const std::string &path,
+                       const std::vector<char> &data) {
+  std::ofstream file(path, std::ios::binary);
+  file.write(data.data(), data.size());
+  file.close();
+  return !file.fail();
+}
+
+/* Open timeline-<algorithm>.json for each of the selected algorithms
+(--timeline). Returns false if one cannot be written.*/
+static bool open_timelines(const std::vector<std::string> &selected,
+                           std::vector<std::unique_ptr<std::ofstream>> &files) {
+  for (auto &i : selected) {
+    const std::string path = "timeline-" + i + ".json";
+    files.emplace_back(new std::ofstream(path, std::ios::binary));
+    if (!*files.back()) {
+      std::cerr << "Cannot write " << path << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Streamed run (--stream): every simulator reads its own stream of the
+processes, generated or read from load, and writes the latency of each
+process to simout-<algorithm>.txt as it terminates. The totals go to
+simout.txt as usual. Returns the exit status.*/
+static int run_streamed(const std::vector<std::string> &selected,
+                        const char *load, const int s, const double lambda,
+                        const int threshold, const int n, const double gap,
+                        const uint32_t slots, const unsigned int threads,
+                        const bool timeline,
+                        const schedule_parameters &parameters) {
+  // The timelines are written to until the simulators go
+  std::vector<std::unique_ptr<std::ofstream>> timelines;
+  if (timeline && !open_timelines(selected, timelines)) {
+    return 1;
+  }
+  std::vector<std::unique_ptr<schedule_algorithm>> simulators;
+  std::vector<std::unique_ptr<std::ofstream>> retired;
+  for (auto &i : selected) {
+    std::unique_ptr<process_stream> stream;
+    if (load != NULL) {
+      stream.reset(new text_stream(load));
+    } else {
+      stream.reset(new generator_stream(s, lambda, threshold, n, gap));
+    }
+    const std::string path = "simout-" + i + ".txt";
+    retired.emplace_back(new std::ofstream(path));
+    if (!*retired.back()) {
+      std::cerr << "Cannot write " << path << "\n";
+      return 1;
+    }
+    simulators.emplace_back(make_streamed_scheduler(
+        i, std::move(stream), slots, retired.back().get(), parameters));
+    simulators.back()->set_output(NULL);
+    if (timeline) {
+      simulators.back()->set_timeline(timelines[simulators.size() - 1].get());
+    }
+  }
+  {
+    thread_pool pool(threads);
+    for (auto &i : simulators) {
+      schedule_algorithm *simulator = i.get();
+      pool.submit([simulator] { simulator->run(); });
+    }
+    pool.wait();
+  }
+  for (unsigned int i = 0; i < simulators.size(); ++i) {
+    const char *error = simulators[i]->get_stream_error();
+    if (error != NULL) {
+      std::cerr << selected[i] << ": the stream " << error << "\n";
+      return 1;
+    }
+  }
+  std::ofstream file("simout.txt");
+  for (unsigned int i = 0; i < simulators.size(); ++i) {
+    file << "Algorithm " << selected[i] << "\n";
+    simulators[i]->write_stats(file);
+  }
+  return 0;
+}
+
+void usage() {
+  std::cerr << "Usage: ./main <seed> <lambda> <upper bound>"
+            << " <n> <t_cs> <alpha> <t_slice> <rr_add>(optional)"
+            << " [--ids=letters|numbers]"
+            << " [--algorithms=SJF,SRT,FCFS,RR,MLFQ,CFS,STRIDE,LOTTERY]"
+            << " [--threads=N] [--trace=LEVEL] [--load=FILE] [--save=FILE]"
+            << " [--save-text=FILE] [--generator=drand48|counter]"
+            << " [--cores=N] [--migration=MS]"
+            << " [--balance=steal|shortest|static] [--mlfq-quanta=MS,MS,...]"
+            << " [--mlfq-boost=MS] [--cfs-latency=MS] [--cfs-granularity=MS]"
+            << " [--cfs-nice=N,N,...] [--tickets=N,N,...]"
+            << " [--switch-resume=MS] [--switch-cache=MS]"
+            << " [--switch-cache-decay=MS]"
+            << " [--predictor=ewma|window|median|adaptive]"
+            << " [--predictor-window=N] [--tau0=MS] [--stream=SLOTS]"
+            << " [--stream-gap=MS] [--save-checkpoint=MS]"
+            << " [--load-checkpoint] [--warmup=MS] [--timeline]\n"
+            << "       ./main --sweep <same arguments, each a list a,b,c or"
+            << " a range first:last:step>\n";
+}
 
 int main(int argc, char const *argv[]) {
   /* argv[1] is s as the random number seed
@@ -19,102 +150,416 @@ int main(int argc, char const *argv[]) {
      argv[7] is t_slice as the time slice value
      argv[8] is rr_add is either BEGINNING or END. END is default
   */
-  if (argc < 8) {
-    std::cerr << "Usage: ./main <seed> <lambda> <upper bound>"
-              << " <n> <t_cs> <alpha> <t_slice> <rr_add>(optional)\n";
+  /* Options start with "--" and can go anywhere:
+     --ids=letters|numbers shows process IDs as A, B, ..., Z, AA, ... or as
+     numbers. Letters by default for up to 26 processes, numbers above.
+     --algorithms=<list> runs only the comma separated algorithms given.
+     The output keeps the order SJF, SRT, FCFS, RR, MLFQ, CFS, STRIDE,
+     LOTTERY. The last four only run when asked for, and only on a single
+     CPU.
+     --threads=N runs the algorithms on N threads, by default one per
+     hardware thread.
+     --trace=LEVEL prints the event log: 1 for arrivals, I/O completions,
+     completed bursts and terminations, 2 for every event. Needs a build
+     with make TRACE=1.
+     --load=FILE simulates the workload in FILE (see workload.h) instead
+     of generating one. seed, upper bound and n are then ignored.
+     --save=FILE and --save-text=FILE write the workload to FILE in the
+     binary or the text format.
+     --generator=drand48|counter picks how workloads are generated:
+     drand48 (the default) gives the sequence the assignment expects,
+     counter generates the processes in parallel (see generator.h).
+     --cores=N simulates a machine with N cores, each with its own ready
+     queue (see multicore.h). simout.txt then also reports the
+     utilization of every core and the migrations between cores.
+     --migration=MS is added to the switch of a process that moves to
+     another core, 0 by default.
+     --balance=steal|shortest|static picks the core a ready process is
+     queued on: the one it last ran on with idle cores stealing work (the
+     default), the least loaded one, or always core ID % N.
+     --mlfq-quanta=<list> gives MLFQ one level per quantum, the first
+     level first. By default it has three, of t_slice, 2 * t_slice and
+     4 * t_slice ms.
+     --mlfq-boost=MS moves every process back to the first MLFQ level
+     every MS ms, 1000 by default; 0 never does.
+     --cfs-latency=MS and --cfs-granularity=MS set the CFS target latency
+     and minimum granularity, by default t_slice and a eighth of that.
+     --cfs-nice=<list> gives the processes these nice values (-20 to 19)
+     in turn by ID, 0 by default.
+     --tickets=<list> gives the processes these numbers of tickets for
+     STRIDE and LOTTERY, in turn by ID, 100 by default. The lottery draws
+     depend on the seed.
+     --switch-resume=MS makes switching in the process that ran last, with
+     nothing else run since, take MS ms instead of t_cs / 2.
+     --switch-cache=MS adds up to MS ms to switching in any other process
+     for its cold cache and TLB, the more the longer ago it last ran, with
+     --switch-cache-decay=MS as time constant (100 by default).
+     --predictor=ewma|window|median|adaptive picks how SJF and SRT
+     estimate the next CPU burst of a process (see predictor.h):
+     exponential averaging with alpha (the default), the mean or the
+     median of its last --predictor-window=N bursts (5 by default), or
+     exponential averaging with an alpha adapted to each process. simout.txt
+     reports how good the estimates were, and so does a sweep once a
+     predictor is given.
+     --tau0=MS estimates the first CPU burst of every process at MS ms
+     instead of 1 / lambda.
+     --stream=SLOTS streams the processes into the simulators instead of
+     building the whole workload first, keeping at most SLOTS of them live
+     at once (see stream.h). They are generated with arrivals on average
+     --stream-gap=MS apart (10000 by default), or read from the --load
+     text file, which must be in arrival order. Nothing is printed; the
+     latency of every process goes to simout-<algorithm>.txt as it
+     terminates. Only SJF, SRT, FCFS and RR can be streamed.
+     --save-checkpoint=MS writes the state of each simulator to
+     checkpoint-<algorithm>.bin once it reaches MS ms, then carries on.
+     --load-checkpoint starts each simulator from its
+     checkpoint-<algorithm>.bin instead of from the beginning, which must
+     have been saved with the same workload. The other parameters may
+     differ, and the log then starts at the checkpoint. Only SJF, SRT,
+     FCFS and RR on a single CPU have checkpoints.
+     --sweep simulates every combination of the positional arguments,
+     each of which can then be a list or a range (see sweep.h), and
+     prints one CSV row per combination instead of the usual output.
+     --warmup=MS makes a sweep simulate the first MS ms of each workload
+     once per algorithm, with the first parameters of the sweep, and
+     carry on every combination from there (see sweep.h). Only SJF, SRT,
+     FCFS and RR on a single CPU can be warmed up.
+     --timeline writes the timeline of each simulator to
+     timeline-<algorithm>.json, to be opened in ui.perfetto.dev or
+     chrome://tracing: what every CPU and every process was doing when,
+     and how many processes were ready and blocked on I/O (see
+     timeline.h).
+  */
+  std::vector<const char *> args;
+  const char *ids = NULL;
+  std::string algorithms = "SJF,SRT,FCFS,RR";
+  unsigned int threads = 0;
+  int trace_level = 0;
+  bool sweep = false;
+  const char *load = NULL;
+  const char *save = NULL;
+  const char *save_text = NULL;
+  generator_kind generator = DRAND48_GENERATOR;
+  int cores = 0;
+  int migration_cost = 0;
+  balance_policy balance = STEAL_BALANCE;
+  std::vector<int> mlfq_quanta;
+  int mlfq_boost = 1000;
+  int cfs_latency = 0;
+  int cfs_granularity = 0;
+  std::vector<int> cfs_nice;
+  std::vector<int> tickets;
+  int switch_resume = -1;
+  int switch_cache = 0;
+  int switch_cache_decay = 100;
+  std::string predictor;
+  int predictor_window = 5;
+  int tau0 = 0;
+  int stream_slots = 0;
+  double stream_gap = 10000;
+  int save_checkpoint = -1;
+  bool load_checkpoint = false;
+  int warmup = 0;
+  bool timeline = false;
+  bool lists_valid = true;
+  for (int i = 0; i < argc; ++i) {
+    if (strncmp(argv[i], "--ids=", 6) == 0) {
+      ids = argv[i] + 6;
+    } else if (strncmp(argv[i], "--algorithms=", 13) == 0) {
+      algorithms = argv[i] + 13;
+    } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+      threads = atoi(argv[i] + 10);
+    } else if (strncmp(argv[i], "--trace=", 8) == 0) {
+      trace_level = atoi(argv[i] + 8);
+    } else if (strncmp(argv[i], "--load=", 7) == 0) {
+      load = argv[i] + 7;
+    } else if (strncmp(argv[i], "--save=", 7) == 0) {
+      save = argv[i] + 7;
+    } else if (strncmp(argv[i], "--save-text=", 12) == 0) {
+      save_text = argv[i] + 12;
+    } else if (strcmp(argv[i], "--generator=drand48") == 0) {
+      generator = DRAND48_GENERATOR;
+    } else if (strcmp(argv[i], "--generator=counter") == 0) {
+      generator = COUNTER_GENERATOR;
+    } else if (strncmp(argv[i], "--cores=", 8) == 0) {
+      cores = atoi(argv[i] + 8);
+    } else if (strncmp(argv[i], "--migration=", 12) == 0) {
+      migration_cost = atoi(argv[i] + 12);
+    } else if (strcmp(argv[i], "--balance=steal") == 0) {
+      balance = STEAL_BALANCE;
+    } else if (strcmp(argv[i], "--balance=shortest") == 0) {
+      balance = SHORTEST_QUEUE_BALANCE;
+    } else if (strcmp(argv[i], "--balance=static") == 0) {
+      balance = STATIC_BALANCE;
+    } else if (strncmp(argv[i], "--mlfq-quanta=", 14) == 0) {
+      lists_valid = lists_valid && parse_list(argv[i] + 14, mlfq_quanta) &&
+                    mlfq_quanta.size() <= multilevel_queue::max_levels &&
+                    *std::min_element(mlfq_quanta.begin(),
+                                      mlfq_quanta.end()) > 0;
+    } else if (strncmp(argv[i], "--mlfq-boost=", 13) == 0) {
+      mlfq_boost = atoi(argv[i] + 13);
+    } else if (strncmp(argv[i], "--cfs-latency=", 14) == 0) {
+      cfs_latency = atoi(argv[i] + 14);
+    } else if (strncmp(argv[i], "--cfs-granularity=", 18) == 0) {
+      cfs_granularity = atoi(argv[i] + 18);
+    } else if (strncmp(argv[i], "--cfs-nice=", 11) == 0) {
+      lists_valid =
+          lists_valid && parse_list(argv[i] + 11, cfs_nice) &&
+          *std::min_element(cfs_nice.begin(), cfs_nice.end()) >= -20 &&
+          *std::max_element(cfs_nice.begin(), cfs_nice.end()) < 20;
+    } else if (strncmp(argv[i], "--tickets=", 10) == 0) {
+      lists_valid = lists_valid && parse_list(argv[i] + 10, tickets) &&
+                    *std::min_element(tickets.begin(), tickets.end()) > 0;
+    } else if (strncmp(argv[i], "--switch-resume=", 16) == 0) {
+      switch_resume = atoi(argv[i] + 16);
+    } else if (strncmp(argv[i], "--switch-cache=", 15) == 0) {
+      switch_cache = atoi(argv[i] + 15);
+    } else if (strncmp(argv[i], "--switch-cache-decay=", 21) == 0) {
+      switch_cache_decay = atoi(argv[i] + 21);
+    } else if (strncmp(argv[i], "--predictor=", 12) == 0) {
+      predictor = argv[i] + 12;
+      lists_valid = lists_valid &&
+                    (predictor == "ewma" || predictor == "window" ||
+                     predictor == "median" || predictor == "adaptive");
+    } else if (strncmp(argv[i], "--predictor-window=", 19) == 0) {
+      predictor_window = atoi(argv[i] + 19);
+      lists_valid = lists_valid && predictor_window > 0;
+    } else if (strncmp(argv[i], "--tau0=", 7) == 0) {
+      tau0 = atoi(argv[i] + 7);
+      lists_valid = lists_valid && tau0 > 0;
+    } else if (strncmp(argv[i], "--stream=", 9) == 0) {
+      stream_slots = atoi(argv[i] + 9);
+      lists_valid = lists_valid && stream_slots > 0;
+    } else if (strncmp(argv[i], "--stream-gap=", 13) == 0) {
+      stream_gap = atof(argv[i] + 13);
+    } else if (strncmp(argv[i], "--save-checkpoint=", 18) == 0) {
+      save_checkpoint = atoi(argv[i] + 18);
+      lists_valid = lists_valid && save_checkpoint >= 0;
+    } else if (strcmp(argv[i], "--load-checkpoint") == 0) {
+      load_checkpoint = true;
+    } else if (strncmp(argv[i], "--warmup=", 9) == 0) {
+      warmup = atoi(argv[i] + 9);
+      lists_valid = lists_valid && warmup > 0;
+    } else if (strcmp(argv[i], "--timeline") == 0) {
+      timeline = true;
+    } else if (strcmp(argv[i], "--sweep") == 0) {
+      sweep = true;
+    } else if (strncmp(argv[i], "--", 2) == 0) {
+      usage();
+      return 1;
+    } else {
+      args.push_back(argv[i]);
+    }
+  }
+  // Selected algorithms in output order
+  const std::vector<std::string> names = {
+      "SJF", "SRT", "FCFS", "RR", "MLFQ", "CFS", "STRIDE", "LOTTERY"};
+  std::vector<std::string> requested;
+  std::stringstream list(algorithms);
+  std::string name;
+  while (std::getline(list, name, ',')) {
+    if (std::find(names.begin(), names.end(), name) == names.end()) {
+      usage();
+      return 1;
+    }
+    requested.push_back(name);
+  }
+  std::vector<std::string> selected;
+  for (auto i : names) {
+    if (std::find(requested.begin(), requested.end(), i) != requested.end()) {
+      selected.push_back(i);
+    }
+  }
+  if (cores < 0 || migration_cost < 0 || !lists_valid || mlfq_boost < 0 ||
+      cfs_latency < 0 || cfs_granularity < 0 || switch_resume < -1 ||
+      switch_cache < 0 || switch_cache_decay <= 0 || stream_gap <= 0) {
+    usage();
     return 1;
   }
-  int s = atoi(argv[1]);
-  double lambda = atof(argv[2]);
-  int threshold = atoi(argv[3]);
-  int n = atoi(argv[4]);
-  int t_cs = atoi(argv[5]);
-  double alpha = atof(argv[6]);
-  int t_slice = atoi(argv[7]);
+  for (auto &i : selected) {
+    if (cores > 0 && i != "SJF" && i != "SRT" && i != "FCFS" && i != "RR") {
+      std::cerr << i << " cannot run with --cores\n";
+      return 1;
+    }
+    if (stream_slots > 0 && i != "SJF" && i != "SRT" && i != "FCFS" &&
+        i != "RR") {
+      std::cerr << i << " cannot run with --stream\n";
+      return 1;
+    }
+    if ((save_checkpoint >= 0 || load_checkpoint || warmup > 0) &&
+        (cores > 0 || stream_slots > 0 ||
+         (i != "SJF" && i != "SRT" && i != "FCFS" && i != "RR"))) {
+      std::cerr << i << " cannot run with checkpoints\n";
+      return 1;
+    }
+  }
+  // The machine; the rest of the parameters come from the arguments
+  schedule_parameters parameters;
+  parameters.cores = cores;
+  parameters.migration_cost = migration_cost;
+  parameters.balance = balance;
+  parameters.mlfq_quanta = mlfq_quanta;
+  parameters.mlfq_boost = mlfq_boost;
+  parameters.cfs_latency = cfs_latency;
+  parameters.cfs_granularity = cfs_granularity;
+  parameters.cfs_nice = cfs_nice;
+  parameters.tickets = tickets;
+  parameters.switch_resume = switch_resume;
+  parameters.switch_cache = switch_cache;
+  parameters.switch_cache_decay = switch_cache_decay;
+  parameters.predictor = predictor;
+  parameters.predictor_window = predictor_window;
+  parameters.tau0 = tau0;
+  if (sweep) {
+    // Sweeps generate their workloads
+    if (load != NULL || save != NULL || save_text != NULL ||
+        stream_slots > 0 || save_checkpoint >= 0 || load_checkpoint ||
+        timeline ||
+        !run_sweep(args, selected, threads, generator, parameters, warmup,
+                   std::cout)) {
+      usage();
+      return 1;
+    }
+    return 0;
+  }
+  if (args.size() < 8 || args.size() > 9 || warmup > 0) {
+    usage();
+    return 1;
+  }
+  int s = atoi(args[1]);
+  double lambda = atof(args[2]);
+  int threshold = atoi(args[3]);
+  int n = atoi(args[4]);
+  int t_cs = atoi(args[5]);
+  double alpha = atof(args[6]);
+  int t_slice = atoi(args[7]);
   bool rr_add = false;
-  if (argc == 9) {
-    if (strcmp(argv[8], "END") == 0) {
+  if (args.size() == 9) {
+    if (strcmp(args[8], "END") == 0) {
       rr_add = false;
-    } else if (strcmp(argv[8], "BEGINNING") == 0) {
+    } else if (strcmp(args[8], "BEGINNING") == 0) {
       rr_add = true;
     } else {
-      std::cerr << "Usage: ./main <s> <lambda> <upper bound>"
-                << " <n> <t_cs> <alpha> <t_slice> <rr_add>(optional)\n";
+      usage();
+      return 1;
+    }
+  }
+  if (n <= 0 && load == NULL) {
+    usage();
+    return 1;
+  }
+  parameters.lottery_seed = s;
+  parameters.t_cs = t_cs;
+  parameters.lambda = lambda;
+  parameters.alpha = alpha;
+  parameters.t_slice = t_slice;
+  parameters.rr_add = rr_add;
+  if (stream_slots > 0) {
+    // Streamed runs hold no workload to save, trace or spread over cores
+    if (save != NULL || save_text != NULL || trace_level > 0 || cores > 0 ||
+        generator != DRAND48_GENERATOR ||
+        (ids != NULL && strcmp(ids, "letters") != 0 &&
+         strcmp(ids, "numbers") != 0)) {
+      usage();
+      return 1;
+    }
+    // The number of processes is not known up front
+    process::set_ID_format(ids != NULL && strcmp(ids, "letters") == 0
+                               ? process::LETTER_IDS
+                               : process::NUMBER_IDS);
+    return run_streamed(selected, load, s, lambda, threshold, n, stream_gap,
+                        stream_slots, threads, timeline, parameters);
+  }
+  std::shared_ptr<workload> processes = std::make_shared<workload>();
+  if (load == NULL && generator == DRAND48_GENERATOR) {
+    *processes = process_generator(s, lambda, threshold, n);
+  } else if (load == NULL) {
+    *processes = counter_generator(s, lambda, threshold, n, threads);
+  } else if (!processes->load(load) || processes->size() == 0) {
+    std::cerr << "Cannot load a workload from " << load << "\n";
+    return 1;
+  }
+  n = processes->size();
+  if (save != NULL && !processes->save(save)) {
+    std::cerr << "Cannot write " << save << "\n";
+    return 1;
+  }
+  if (save_text != NULL && !processes->save_text(save_text)) {
+    std::cerr << "Cannot write " << save_text << "\n";
+    return 1;
+  }
+  if (trace_level > 0 && !event_trace::compiled_in) {
+    std::cerr << "Warning: built without SCHED_TRACE, --trace is ignored\n";
+  }
+  if (ids == NULL) {
+    process::set_ID_format(n <= 26 ? process::LETTER_IDS : process::NUMBER_IDS);
+  } else if (strcmp(ids, "letters") == 0) {
+    process::set_ID_format(process::LETTER_IDS);
+  } else if (strcmp(ids, "numbers") == 0) {
+    process::set_ID_format(process::NUMBER_IDS);
+  } else {
+    usage();
+    return 1;
+  }
+
+  // The timelines are written to until the simulators go
+  std::vector<std::unique_ptr<std::ofstream>> timelines;
+  if (timeline && !open_timelines(selected, timelines)) {
+    return 1;
+  }
+  std::vector<std::unique_ptr<schedule_algorithm>> simulators;
+  for (auto &i : selected) {
+    simulators.emplace_back(make_scheduler(i, processes, parameters));
+    simulators.back()->set_trace_level(trace_level);
+    if (timeline) {
+      simulators.back()->set_timeline(timelines[simulators.size() - 1].get());
+    }
+    const std::string path = "checkpoint-" + i + ".bin";
+    std::vector<char> checkpoint;
+    if (load_checkpoint && (!read_file(path, checkpoint) ||
+                            !simulators.back()->restore(checkpoint))) {
+      std::cerr << "Cannot restore " << i << " from " << path << "\n";
       return 1;
     }
   }
-  std::vector<process> processes = process_generator(s, lambda, threshold, n);
+  std::vector<std::ostringstream> logs(simulators.size());
+  std::vector<std::vector<char>> checkpoints(simulators.size());
 
-  SJF_scheduling SJF_simulator(processes, t_cs, lambda, alpha);
-  SJF_simulator.run();
-  std::cout << std::endl;
-  SRT_scheduling SRT_simulator(processes, t_cs, lambda, alpha);
-  SRT_simulator.run();
-  std::cout << std::endl;
-  FCFS_scheduling FCFS_simulator(processes, t_cs);
-  FCFS_simulator.run();
-  std::cout << std::endl;
-  RR_scheduling RR_simulator(processes, t_cs, t_slice, rr_add);
-  RR_simulator.run();
+  // The simulators share nothing, so they can all run at once
+  {
+    thread_pool pool(threads);
+    for (unsigned int i = 0; i < simulators.size(); ++i) {
+      pool.submit([&simulators, &logs, &checkpoints, save_checkpoint, i] {
+        simulators[i]->set_output(&logs[i]);
+        if (save_checkpoint >= 0) {
+          simulators[i]->run_until(save_checkpoint);
+          simulators[i]->save(checkpoints[i]);
+        }
+        simulators[i]->run();
+      });
+    }
+    pool.wait();
+  }
+  for (unsigned int i = 0; save_checkpoint >= 0 && i < selected.size(); ++i) {
+    const std::string path = "checkpoint-" + selected[i] + ".bin";
+    if (!write_file(path, checkpoints[i])) {
+      std::cerr << "Cannot write " << path << "\n";
+      return 1;
+    }
+  }
+  for (unsigned int i = 0; i < simulators.size(); ++i) {
+    if (i > 0) {
+      std::cout << std::endl;
+    }
+    std::cout << logs[i].str();
+  }
 
   // Write stats to file
   std::ofstream file("simout.txt");
-  file << "Algorithm SJF\n";
-  SJF_simulator.write_stats(file);
-  file << "Algorithm SRT\n";
-  SRT_simulator.write_stats(file);
-  file << "Algorithm FCFS\n";
-  FCFS_simulator.write_stats(file);
-  file << "Algorithm RR\n";
-  RR_simulator.write_stats(file);
+  for (unsigned int i = 0; i < simulators.size(); ++i) {
+    file << "Algorithm " << selected[i] << "\n";
+    simulators[i]->write_stats(file);
+  }
   file.close();
   return 0;
 }
-
-std::vector<process> process_generator(const int s, const double lambda,
-                                       const int threshold, const int n) {
-  // Initialize the random number table with given seed
-  srand48(s);
-  // Initialize the map for storing processes.
-  std::vector<process> processes;
-  // Initialize the process ID
-  char process_ID = 'A';
-  // no more than 26 processes to simulate
-  assert(n > 0 && n < 27);
-  for (int i = 0; i < n; ++i) {
-    double r = drand48();
-    int arrival_time = (int)(-log(r) / lambda);
-    if (arrival_time > threshold) {
-      --i;
-      continue;
-    }
-    r = drand48();
-    int n_cpu_bursts = (int)(r * 100) + 1;
-    std::vector<int> time_sequence;
-    time_sequence.resize(n_cpu_bursts * 2 - 1);
-    for (int j = 0; j < n_cpu_bursts; ++j) {
-      r = drand48();
-      int cpu_time = threshold + 1;
-      while (cpu_time > threshold) {
-        cpu_time = (int)ceil(-log(r) / lambda);
-        if (cpu_time > threshold)
-          r = drand48();
-      }
-      time_sequence[2 * j] = cpu_time;
-      if (j == n_cpu_bursts - 1)
-        break;
-      r = drand48();
-      int io_time = threshold + 1;
-      while (io_time > threshold) {
-        io_time = (int)ceil(-log(r) / lambda);
-        if (io_time > threshold)
-          r = drand48();
-      }
-      time_sequence[2 * j + 1] = io_time;
-    }
-    process tmp_process(arrival_time, process_ID, time_sequence);
-    processes.push_back(tmp_process);
-    ++process_ID;
-  }
-  return processes;
-}
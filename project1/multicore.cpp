@@ -0,0 +1,319 @@
+#include "multicore.h"
+
+multicore_scheduling::multicore_scheduling(
+    std::shared_ptr<const workload> p, const std::string &name,
+    const schedule_parameters &parameters)
+    : schedule_algorithm(p, parameters.t_cs, name),
+      cores(parameters.cores), migration_cost(parameters.migration_cost),
+      balance(parameters.balance), t_slice(parameters.t_slice),
+      rr_add(parameters.rr_add), sliced(name == "RR"),
+      estimated(name == "SJF" || name == "SRT"), preemptive(name == "SRT"),
+      ready_at(processes.size(), 0), last_core(processes.size(), -1),
+      end_time(0) {
+  assert(parameters.cores > 0);
+  if (estimated) {
+    predictor.reset(new ewma_predictor(1 / parameters.lambda,
+                                       parameters.alpha));
+  }
+  for (auto &c : cores) {
+    if (name == "SJF") {
+      c.queue.reset(new indexed_heap_queue(processes, ShorterJobTime));
+      c.shortest.reset(new indexed_heap_queue(processes, ShorterActualTime));
+    } else if (name == "SRT") {
+      c.queue.reset(new indexed_heap_queue(processes, ShorterRemainingTime));
+      c.shortest.reset(new indexed_heap_queue(processes, ShorterActualTime));
+    } else {
+      c.queue.reset(new fifo_queue(processes));
+    }
+    c.phase = IDLE;
+    c.current = c.last = processes.end();
+    c.until = c.since = c.slice_end = c.busy = 0;
+    c.migrations = 0;
+  }
+}
+
+void multicore_scheduling::run() {
+  print_overview();
+  while (!all_terminated()) {
+    // Bursts that ended since the last event
+    for (auto &c : cores) {
+      if (c.phase == RUNNING && catch_up(c) != 1) {
+        if (c.current->get_state() == 0 && estimated) {
+          // Recalculate tau for the process that completes its burst
+          next_estimate(c.current);
+        } else if (estimated) {
+          score_estimate(c.current);
+        }
+        switch_out(c);
+      }
+    }
+    // Switches that are done
+    for (auto &c : cores) {
+      if (c.phase == SWITCH_OUT && c.until == time) {
+        switched_out(c);
+      }
+    }
+    for (auto &c : cores) {
+      if (c.phase == SWITCH_IN && c.until == time) {
+        c.phase = RUNNING;
+        c.since = time;
+        show_state(c.current, TIMELINE_RUNNING, time);
+        show_cpu(&c - &cores[0], TIMELINE_RUNNING, c.current, time);
+        record_response(c.current,
+                        time - ready_at[c.current - processes.begin()]);
+        c.slice_end = time + t_slice;
+        // A shorter process may have been queued during the switch
+        if (preemptive && !c.queue->empty() &&
+            ShorterRemainingTime(c.queue->front(), c.current)) {
+          ++n_preemption;
+          switch_out(c);
+        }
+      }
+    }
+    // Arrivals and I/O completions, ties by ID
+    skip_past_arrivals();
+    while (next_arrival < arrival_order.size() &&
+           arrival(next_arrival)->get_arrival_time() == time) {
+      process_ptr p = arrival(next_arrival);
+      if (estimated) {
+        // Set tau0 for new process before it is ordered by it
+        start_estimate(p);
+      }
+      woken.push_back(p);
+      ++next_arrival;
+    }
+    while (!blocked.empty() && blocked.next() <= time) {
+      process_ptr p = blocked.pop();
+      // Bring the process to the end of its I/O burst
+      p->block_for(p->get_remaining_time());
+      woken.push_back(p);
+    }
+    std::sort(woken.begin(), woken.end(), resolveTie);
+    for (auto i : woken) {
+      make_ready(i, true);
+    }
+    woken.clear();
+    if (sliced) {
+      expire_slices();
+    }
+    // Give idle cores work, from their own queue first
+    for (size_t i = 0; i < cores.size(); ++i) {
+      if (cores[i].phase == IDLE && !cores[i].queue->empty()) {
+        process_ptr p = cores[i].queue->front();
+        cores[i].queue->pop_front();
+        score_dispatch(p, cores[i].shortest.get());
+        switch_in(i, p);
+      }
+    }
+    if (balance == STEAL_BALANCE) {
+      for (size_t i = 0; i < cores.size(); ++i) {
+        if (cores[i].phase == IDLE && !steal(i)) {
+          break;
+        }
+      }
+    }
+    if (all_terminated()) {
+      break;
+    }
+    sim_time next;
+    if (!next_event(next)) {
+      break;
+    }
+    time = next;
+  }
+  end_time = time;
+  finish_timeline();
+}
+
+void multicore_scheduling::write_stats(std::ofstream &file) {
+  schedule_algorithm::write_stats(file);
+  for (size_t i = 0; i < cores.size(); ++i) {
+    file << "-- core " << i << " utilization: "
+         << (end_time > 0 ? 100.0 * cores[i].busy / end_time : 0.0)
+         << "%, migrations in: " << cores[i].migrations << "\n";
+  }
+  file << "-- total number of migrations: " << get_stats().migrations << "\n";
+}
+
+const schedule_stats multicore_scheduling::get_stats() const {
+  schedule_stats stats = schedule_algorithm::get_stats();
+  sim_time busy = 0;
+  for (auto &c : cores) {
+    stats.migrations += c.migrations;
+    busy += c.busy;
+  }
+  if (end_time > 0) {
+    stats.utilization = (double)busy / end_time / cores.size();
+  }
+  return stats;
+}
+
+int multicore_scheduling::catch_up(core &c) {
+  if (time > c.since) {
+    c.current->run_for(time - c.since);
+    c.busy += time - c.since;
+    c.since = time;
+  }
+  return c.current->get_state();
+}
+
+void multicore_scheduling::make_ready(process_ptr p, const bool new_burst) {
+  if (new_burst) {
+    ready_at[p - processes.begin()] = time;
+  }
+  core &c = cores[choose_core(p)];
+  enqueued[p - processes.begin()] = time;
+  if (sliced && rr_add) {
+    c.queue->push_front(p);
+  } else {
+    c.queue->push_back(p);
+  }
+  if (c.shortest != NULL) {
+    c.shortest->push_back(p);
+  }
+  show_state(p, TIMELINE_READY, time);
+  show_counts();
+  if (preemptive && c.phase == RUNNING &&
+      ShorterRemainingTime(p, c.current)) {
+    ++n_preemption;
+    switch_out(c);
+  }
+}
+
+size_t multicore_scheduling::choose_core(process_ptr p) const {
+  const int last = last_core[p - processes.begin()];
+  if (balance == STATIC_BALANCE) {
+    return p->get_ID() % cores.size();
+  }
+  if (balance == STEAL_BALANCE && last != -1) {
+    return last;
+  }
+  size_t best = 0;
+  for (size_t i = 1; i < cores.size(); ++i) {
+    if (load(cores[i]) < load(cores[best])) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+size_t multicore_scheduling::ready_processes() const {
+  size_t ready = 0;
+  for (auto &c : cores) {
+    ready += c.queue->size();
+  }
+  return ready;
+}
+
+size_t multicore_scheduling::load(const core &c) const {
+  return c.queue->size() + (c.phase == IDLE ? 0 : 1);
+}
+
+void multicore_scheduling::switch_out(core &c) {
+  catch_up(c);
+  c.phase = SWITCH_OUT;
+  c.until = time + switch_out_cost(c.current);
+  c.last = c.current;
+  show_state(c.current, TIMELINE_SWITCH_OUT, time);
+  show_cpu(&c - &cores[0], TIMELINE_SWITCH_OUT, c.current, time);
+}
+
+void multicore_scheduling::switched_out(core &c) {
+  process_ptr p = c.current;
+  c.phase = IDLE;
+  c.current = processes.end();
+  show_cpu(&c - &cores[0], TIMELINE_IDLE, p, time);
+  if (p->get_state() == 1) {
+    // Preempted, back to a ready queue
+    make_ready(p, false);
+    return;
+  }
+  add_turnaround(p, time - ready_at[p - processes.begin()]);
+  complete_burst(p);
+  if (p->get_state() == 0) {
+    blocked.add(p, time + p->get_remaining_time());
+    show_state(p, TIMELINE_IO, time);
+  } else {
+    show_state(p, TIMELINE_IDLE, time);
+    ++n_terminated;
+  }
+  show_counts();
+}
+
+void multicore_scheduling::switch_in(const size_t i, process_ptr p) {
+  core &c = cores[i];
+  add_wait(p, time - enqueued[p - processes.begin()]);
+  int &last = last_core[p - processes.begin()];
+  c.phase = SWITCH_IN;
+  c.current = p;
+  c.until = time + switch_in_cost(p, c.last);
+  if (last != -1 && last != (int)i) {
+    c.until += migration_cost;
+    ++c.migrations;
+  }
+  last = i;
+  ++n_cs;
+  show_state(p, TIMELINE_SWITCH_IN, time);
+  show_cpu(i, TIMELINE_SWITCH_IN, p, time);
+  show_counts();
+}
+
+bool multicore_scheduling::steal(const size_t i) {
+  size_t victim = i;
+  for (size_t j = 0; j < cores.size(); ++j) {
+    if (cores[j].queue->size() > cores[victim].queue->size()) {
+      victim = j;
+    }
+  }
+  if (victim == i) {
+    return false;
+  }
+  process_ptr p = cores[victim].queue->front();
+  cores[victim].queue->pop_front();
+  score_dispatch(p, cores[victim].shortest.get());
+  switch_in(i, p);
+  return true;
+}
+
+void multicore_scheduling::expire_slices() {
+  for (auto &c : cores) {
+    if (c.phase != RUNNING) {
+      continue;
+    }
+    // Slices that ended while nobody was waiting started over
+    if (c.slice_end < time) {
+      c.slice_end += (time - c.slice_end + t_slice - 1) / t_slice * t_slice;
+    }
+    if (c.slice_end != time) {
+      continue;
+    }
+    if (c.queue->empty()) {
+      c.slice_end = time + t_slice;
+    } else {
+      ++n_preemption;
+      switch_out(c);
+    }
+  }
+}
+
+bool multicore_scheduling::next_event(sim_time &next) const {
+  next = std::numeric_limits<sim_time>::max();
+  if (next_arrival < arrival_order.size()) {
+    next = std::min<sim_time>(
+        next, processes[arrival_order[next_arrival]].get_arrival_time());
+  }
+  if (!blocked.empty()) {
+    next = std::min(next, blocked.next());
+  }
+  for (auto &c : cores) {
+    if (c.phase == SWITCH_IN || c.phase == SWITCH_OUT) {
+      next = std::min(next, c.until);
+    } else if (c.phase == RUNNING) {
+      next = std::min<sim_time>(next, c.since + c.current->get_remaining_time());
+      if (sliced && !c.queue->empty()) {
+        next = std::min(next, c.slice_end);
+      }
+    }
+  }
+  return next != std::numeric_limits<sim_time>::max();
+}
@@ -0,0 +1,94 @@
+/* Simulation of a machine with several cores. Every core has its own
+ready queue, ordered the way the single CPU policy orders its queue
+(FCFS, RR, SJF or SRT), and a balance_policy decides which queue a
+process that becomes ready goes to. Moving a process to another core
+adds migration_cost to its switch in.
+
+Time jumps from one event to the next (arrival, I/O completion, end of a
+switch, burst or time slice) instead of going ms by ms. Switches are
+costed by the same model as on the single CPU, where a process resumes
+when it was the last one switched out of the core, but the multi-core
+runs are not meant to reproduce the single CPU simulators' output: they
+have no event log, and wait and turnaround times are measured from the
+time a burst becomes ready to the time it is switched out.
+ */
+#ifndef MULTICORE
+#define MULTICORE
+
+#include "schedule_algorithm.h"
+
+class multicore_scheduling : public schedule_algorithm {
+public:
+  // Simulate the policy called name on parameters.cores cores
+  multicore_scheduling(std::shared_ptr<const workload> p,
+                       const std::string &name,
+                       const schedule_parameters &parameters);
+  void run();
+  // Adds the utilization of each core and the number of migrations
+  void write_stats(std::ofstream &);
+  const schedule_stats get_stats() const;
+
+private:
+  enum core_phase { IDLE, SWITCH_IN, RUNNING, SWITCH_OUT };
+  struct core {
+    core_phase phase;
+    // The process being switched in, running or being switched out
+    process_ptr current;
+    // The process last switched out of the core
+    process_ptr last;
+    std::unique_ptr<process_queue> queue;
+    // The queue by actual remaining time, with burst estimates only
+    std::unique_ptr<indexed_heap_queue> shortest;
+    // End of the current switch
+    sim_time until;
+    // Time up to which the running process has been run
+    sim_time since;
+    // End of the time slice of the running process (RR)
+    sim_time slice_end;
+    // Time spent running processes
+    sim_time busy;
+    int migrations;
+  };
+  // Not used, processes are queued by make_ready
+  void perform_add_to_ready_queue() {}
+  // Run the process on core c up to now. Returns its state
+  int catch_up(core &c);
+  // Process p is ready, for a new burst if new_burst is true
+  void make_ready(process_ptr p, const bool new_burst);
+  // Index of the core the ready process p is queued on
+  size_t choose_core(process_ptr p) const;
+  // Processes in the queues of all the cores
+  size_t ready_processes() const;
+  // Number of processes a core has to get through
+  size_t load(const core &c) const;
+  // Start switching out the process on core c
+  void switch_out(core &c);
+  // Finish switching out the process on core c
+  void switched_out(core &c);
+  // Start switching in p on core i
+  void switch_in(const size_t i, process_ptr p);
+  // Take a process from the longest queue for core i. False if none
+  bool steal(const size_t i);
+  // Preempt the processes whose time slice ends now (RR)
+  void expire_slices();
+  // Time of the next event after now. Returns false if there is none
+  bool next_event(sim_time &) const;
+  std::vector<core> cores;
+  const int migration_cost;
+  const balance_policy balance;
+  const int t_slice;
+  const bool rr_add;
+  // The policy: time slices for RR, burst estimates for SJF and SRT,
+  // preemption for SRT
+  bool sliced;
+  bool estimated;
+  bool preemptive;
+  // Time the current burst of each process became ready
+  std::vector<sim_time> ready_at;
+  // Core each process last ran on, -1 before it ran
+  std::vector<int> last_core;
+  // Time the last process was switched out
+  sim_time end_time;
+};
+
+#endif
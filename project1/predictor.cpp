@@ -0,0 +1,129 @@
+#include "predictor.h"
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+burst_predictor::burst_predictor(const int tau0) : tau0(tau0) {
+  stats.bursts = stats.error = stats.absolute_error = 0;
+  stats.dispatches = stats.misordered = 0;
+}
+
+void burst_predictor::score(const int tau, const int t) {
+  ++stats.bursts;
+  stats.error += tau - t;
+  stats.absolute_error += abs(tau - t);
+}
+
+void burst_predictor::save(snapshot_writer &w) const {
+  const std::string name = get_name();
+  w.put_vector(std::vector<char>(name.begin(), name.end()));
+  w.put(stats);
+  save_history(w);
+}
+
+bool burst_predictor::restore(snapshot_reader &r) {
+  std::vector<char> name;
+  prediction_stats saved;
+  if (!r.get_vector(name) ||
+      std::string(name.begin(), name.end()) != get_name() || !r.get(saved) ||
+      !restore_history(r)) {
+    return false;
+  }
+  stats = saved;
+  return true;
+}
+
+int ewma_predictor::estimate(const uint32_t, const int tau, const int t) {
+  return (int)ceil(alpha * t + (1 - alpha) * tau);
+}
+
+history_predictor::history_predictor(const uint32_t n, const int tau0,
+                                     const int window)
+    : burst_predictor(tau0), window(window), bursts((size_t)n * window),
+      filled(n, 0), next(n, 0) {}
+
+void history_predictor::remember(const uint32_t i, const int t) {
+  bursts[(size_t)i * window + next[i]] = t;
+  next[i] = (next[i] + 1) % window;
+  filled[i] = std::min(filled[i] + 1, window);
+}
+
+void history_predictor::save_history(snapshot_writer &w) const {
+  w.put(window);
+  w.put_vector(bursts);
+  w.put_vector(filled);
+  w.put_vector(next);
+}
+
+bool history_predictor::restore_history(snapshot_reader &r) {
+  int saved_window;
+  std::vector<int> saved_bursts, saved_filled, saved_next;
+  if (!r.get(saved_window) || saved_window != window ||
+      !r.get_vector(saved_bursts) || saved_bursts.size() != bursts.size() ||
+      !r.get_vector(saved_filled) || saved_filled.size() != filled.size() ||
+      !r.get_vector(saved_next) || saved_next.size() != next.size()) {
+    return false;
+  }
+  bursts.swap(saved_bursts);
+  filled.swap(saved_filled);
+  next.swap(saved_next);
+  return true;
+}
+
+int window_predictor::estimate(const uint32_t i, const int, const int t) {
+  remember(i, t);
+  int64_t sum = 0;
+  for (int j = 0; j < filled[i]; ++j) {
+    sum += bursts[(size_t)i * window + j];
+  }
+  return (sum + filled[i] - 1) / filled[i];
+}
+
+int median_predictor::estimate(const uint32_t i, const int, const int t) {
+  remember(i, t);
+  const int n = filled[i];
+  const int *history = &bursts[(size_t)i * window];
+  std::copy(history, history + n, sorted.begin());
+  std::sort(sorted.begin(), sorted.begin() + n);
+  // The mean of the two middle bursts of an even number, rounded up
+  return (sorted[(n - 1) / 2] + sorted[n / 2] + 1) / 2;
+}
+
+const double adaptive_predictor::smoothing = 0.2;
+const double adaptive_predictor::least_alpha = 0.05;
+
+adaptive_predictor::adaptive_predictor(const uint32_t n, const int tau0,
+                                       const double alpha)
+    : burst_predictor(tau0), alpha(alpha), processes(n) {}
+
+void adaptive_predictor::forget(const uint32_t i) {
+  processes[i].alpha = alpha;
+  processes[i].error = 0;
+  processes[i].absolute_error = 0;
+}
+
+int adaptive_predictor::estimate(const uint32_t i, const int tau,
+                                 const int t) {
+  tracking &p = processes[i];
+  const double error = t - tau;
+  p.error = smoothing * error + (1 - smoothing) * p.error;
+  p.absolute_error =
+      smoothing * fabs(error) + (1 - smoothing) * p.absolute_error;
+  if (p.absolute_error > 0) {
+    p.alpha = std::max(least_alpha, fabs(p.error) / p.absolute_error);
+  }
+  return (int)ceil(p.alpha * t + (1 - p.alpha) * tau);
+}
+
+void adaptive_predictor::save_history(snapshot_writer &w) const {
+  w.put_vector(processes);
+}
+
+bool adaptive_predictor::restore_history(snapshot_reader &r) {
+  std::vector<tracking> saved;
+  if (!r.get_vector(saved) || saved.size() != processes.size()) {
+    return false;
+  }
+  processes.swap(saved);
+  return true;
+}
@@ -0,0 +1,169 @@
+/* Estimates of the next CPU burst of each process, which SJF and SRT
+order their ready queues by. Every process starts with tau0, and after
+each CPU burst the predictor turns the burst it just completed and the
+estimate it had into the estimate of the next one:
+- ewma: exponential averaging, alpha * t + (1 - alpha) * tau, as in the
+  assignment;
+- window: the mean of the last window bursts;
+- median: the median of the last window bursts, which ignores a few
+  outliers;
+- adaptive: exponential averaging with an alpha of its own per process,
+  adapted after each burst to |E| / M (Trigg and Leach), E and M being
+  the smoothed error and absolute error of its estimates. Processes whose
+  bursts drift get a higher alpha than ones whose bursts scatter.
+Estimates are rounded up to whole ms, like the assignment's.
+
+The predictor also keeps score of its estimates: the error of every
+completed burst, and how many of the dispatches ran a process while
+the one shortest remaining time first would have run had a shorter
+burst left and a different estimate, so that the estimates put them in
+the wrong order. Processes are identified by their position in the
+process vector.
+ */
+#ifndef PREDICTOR
+#define PREDICTOR
+
+#include "snapshot.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// How good the estimates were so far
+struct prediction_stats {
+  // Completed bursts, and the sums of the estimate minus the burst and of
+  // its absolute value
+  int64_t bursts;
+  int64_t error;
+  int64_t absolute_error;
+  // Dispatches, and those with a shorter burst left in the queue
+  int64_t dispatches;
+  int64_t misordered;
+};
+
+class burst_predictor {
+public:
+  burst_predictor(const int tau0);
+  virtual ~burst_predictor() {}
+  // Name of the predictor, e.g. "ewma"
+  virtual const char *get_name() const = 0;
+  // Estimate of the first burst of process i, which forgets its history
+  const int first(const uint32_t i) {
+    forget(i);
+    return tau0;
+  };
+  /* Process i completed a burst of t ms estimated at tau ms. Returns the
+  estimate of its next burst.*/
+  const int next(const uint32_t i, const int tau, const int t) {
+    score(tau, t);
+    return estimate(i, tau, t);
+  };
+  // Count a burst of t ms estimated at tau ms, the last of its process
+  void score(const int tau, const int t);
+  // Count a dispatch, misordered if a shorter burst was left in the queue
+  void score_dispatch(const bool misordered) {
+    ++stats.dispatches;
+    stats.misordered += misordered;
+  };
+  const prediction_stats &get_stats() const { return stats; };
+  /* Checkpoints (see schedule_algorithm::save): the score and the
+  history of every process. restore changes nothing when it returns
+  false.*/
+  void save(snapshot_writer &) const;
+  bool restore(snapshot_reader &);
+
+protected:
+  virtual void forget(const uint32_t i) = 0;
+  virtual int estimate(const uint32_t i, const int tau, const int t) = 0;
+  // The history of the processes, for checkpoints
+  virtual void save_history(snapshot_writer &) const {}
+  virtual bool restore_history(snapshot_reader &) { return true; };
+
+private:
+  const int tau0;
+  prediction_stats stats;
+};
+
+class ewma_predictor : public burst_predictor {
+public:
+  ewma_predictor(const int tau0, const double alpha)
+      : burst_predictor(tau0), alpha(alpha) {}
+  const char *get_name() const { return "ewma"; };
+
+protected:
+  void forget(const uint32_t) {}
+  int estimate(const uint32_t i, const int tau, const int t);
+
+private:
+  const double alpha;
+};
+
+/* What the window and median predictors share: the last window bursts
+of each process, oldest first from next[i] on.*/
+class history_predictor : public burst_predictor {
+public:
+  history_predictor(const uint32_t n, const int tau0, const int window);
+
+protected:
+  void forget(const uint32_t i) { filled[i] = 0; };
+  // Add a burst of t ms to the history of process i
+  void remember(const uint32_t i, const int t);
+  void save_history(snapshot_writer &) const;
+  bool restore_history(snapshot_reader &);
+  const int window;
+  std::vector<int> bursts;
+  // Bursts in the history of each process, and where the next one goes
+  std::vector<int> filled;
+  std::vector<int> next;
+};
+
+class window_predictor : public history_predictor {
+public:
+  window_predictor(const uint32_t n, const int tau0, const int window)
+      : history_predictor(n, tau0, window) {}
+  const char *get_name() const { return "window"; };
+
+protected:
+  int estimate(const uint32_t i, const int tau, const int t);
+};
+
+class median_predictor : public history_predictor {
+public:
+  median_predictor(const uint32_t n, const int tau0, const int window)
+      : history_predictor(n, tau0, window), sorted(window) {}
+  const char *get_name() const { return "median"; };
+
+protected:
+  int estimate(const uint32_t i, const int tau, const int t);
+
+private:
+  // Scratch space to find the median in
+  std::vector<int> sorted;
+};
+
+class adaptive_predictor : public burst_predictor {
+public:
+  // Every process starts with alpha
+  adaptive_predictor(const uint32_t n, const int tau0, const double alpha);
+  const char *get_name() const { return "adaptive"; };
+
+protected:
+  void forget(const uint32_t i);
+  int estimate(const uint32_t i, const int tau, const int t);
+  void save_history(snapshot_writer &) const;
+  bool restore_history(snapshot_reader &);
+
+private:
+  // Smoothing of the errors, and the least alpha a process can get
+  static const double smoothing;
+  static const double least_alpha;
+  const double alpha;
+  // Per process: alpha, and the smoothed error and absolute error
+  struct tracking {
+    double alpha;
+    double error;
+    double absolute_error;
+  };
+  std::vector<tracking> processes;
+};
+
+#endif
@@ -1,42 +1,52 @@
 #include "process.h"
 
-process::process() : arrival_time(0), ID('A') {}
+process::ID_format process::ID_style = process::LETTER_IDS;
 
-process::process(const process &p) : arrival_time(p.arrival_time), ID(p.ID) {
-  this->time_sequence = p.time_sequence;
+process::process()
+    : arrival_time(0), ID(0), time_sequence(NULL), n_bursts(0) {}
+
+process::process(const process &p)
+    : arrival_time(p.arrival_time), ID(p.ID), time_sequence(p.time_sequence),
+      n_bursts(p.n_bursts) {
   this->reset();
 }
 
-process::process(const int t, char id, const std::vector<int> &time_sequence)
-    : arrival_time(t), ID(id), time_sequence(time_sequence) {
+process::process(const int t, const uint32_t id, const int *time_sequence,
+                 const uint32_t n_bursts)
+    : arrival_time(t), ID(id), time_sequence(time_sequence),
+      n_bursts(n_bursts) {
   // Size must be odd. Since first and last bursts are CPU
-  assert(time_sequence.size() % 2);
+  assert(n_bursts % 2);
   this->reset();
 }
 
-const int process::get_remaining_CPU_bursts() const {
-  int bursts = 0;
-  int tmp_time = current_time;
-  for (unsigned int i = 0; i < time_sequence.size(); ++i) {
-    if (tmp_time > time_sequence[i])
-      tmp_time -= time_sequence[i];
-    else {
-      bursts = (time_sequence.size() - i) / 2;
-      break;
-    }
-    if (i == time_sequence.size() - 1) {
-      break;
-    }
+const std::string process::name(const uint32_t id) {
+  if (ID_style == NUMBER_IDS) {
+    return std::to_string(id);
+  }
+  // Count in base 26 the way spreadsheet columns do: A-Z, AA-ZZ, AAA...
+  std::string name;
+  uint32_t n = id + 1;
+  while (n > 0) {
+    name.insert(name.begin(), 'A' + (n - 1) % 26);
+    n = (n - 1) / 26;
   }
-  return bursts;
+  return name;
+}
+
+const int process::get_remaining_CPU_bursts() const {
+  // At the very beginning of a burst we still count the previous one
+  const unsigned int i =
+      (burst_offset == 0 && burst_index > 0) ? burst_index - 1 : burst_index;
+  return (n_bursts - i) / 2;
 }
 
 const int process::preempted() const {
-  return (current_time && query_state(current_time - 1) && state);
+  return (current_time && previous_state() && state);
 }
 
 const int process::get_last_burst_time() const {
-  int bursted = time_sequence.size() / 2 - get_remaining_CPU_bursts();
+  int bursted = n_bursts / 2 - get_remaining_CPU_bursts();
   return time_sequence[2 * bursted];
 }
 
@@ -48,7 +58,6 @@ void process::set_estimated_remaining_time(const int t) {
 const int process::run_for_1ms() {
   assert(state == 1);
   const int next = this->proceed();
-  ++turnaround_time;
   if (next) {
     --remaining_time;
     --estimated_remaining_time;
@@ -56,15 +65,6 @@ const int process::run_for_1ms() {
   return next;
 }
 
-const int process::wait_for_1ms(bool increase_wait_time = true) {
-  if (increase_wait_time)
-    ++wait_time;
-  // Only increase turnaround time after first running
-  if (query_state(current_time - 1) == 1)
-    ++turnaround_time;
-  return state;
-}
-
 const int process::block_for_1ms() {
   assert(state == 0);
   --remaining_time;
@@ -72,55 +72,95 @@ const int process::block_for_1ms() {
   return next;
 }
 
+const int process::run_for(const int ms) {
+  assert(state == 1 && ms > 0 && ms <= remaining_time);
+  // Nothing changes state before the last ms, so skip to it directly
+  current_time += ms - 1;
+  burst_offset += ms - 1;
+  remaining_time -= ms - 1;
+  estimated_remaining_time -= ms - 1;
+  return run_for_1ms();
+}
+
+const int process::block_for(const int ms) {
+  assert(state == 0 && ms > 0 && ms <= remaining_time);
+  current_time += ms - 1;
+  burst_offset += ms - 1;
+  remaining_time -= ms - 1;
+  return block_for_1ms();
+}
+
 void process::print() {
-  std::cout << "Process " << ID << " [NEW] (arrival time " << arrival_time
-            << " ms) " << time_sequence.size() / 2 + 1 << " CPU bursts\n";
-  for (unsigned int i = 0; i < time_sequence.size(); ++i) {
+  std::cout << "Process " << get_name() << " [NEW] (arrival time "
+            << arrival_time << " ms) " << n_bursts / 2 + 1 << " CPU bursts\n";
+  for (unsigned int i = 0; i < n_bursts; ++i) {
     std::cout << "--> CPU burst " << time_sequence[i] << " ms";
     ++i;
-    if (i < time_sequence.size())
+    if (i < n_bursts)
       std::cout << " --> I/O burst " << time_sequence[i] << " ms";
     std::cout << std::endl;
   }
 }
 
-void process::print_overview() {
-  std::string plural = time_sequence.size() > 1 ? " bursts" : " burst";
-  std::cout << "Process " << ID << " [NEW] (arrival time " << arrival_time
-            << " ms) " << time_sequence.size() / 2 + 1 << " CPU" << plural
-            << std::endl;
+void process::print_overview(std::ostream &out) {
+  std::string plural = n_bursts > 1 ? " bursts" : " burst";
+  out << "Process " << get_name() << " [NEW] (arrival time " << arrival_time
+      << " ms) " << n_bursts / 2 + 1 << " CPU" << plural << "\n";
 }
 
 void process::reset() {
-  wait_time = 0;
-  turnaround_time = 0;
   current_time = 0;
+  burst_index = 0;
+  burst_offset = 0;
   state = 1;
   remaining_time = 0;
   total_time = 0;
   estimated_remaining_time = 0;
   last_estimated_burst_time = 0;
-  for (unsigned int i = 0; i < time_sequence.size(); ++i) {
+  for (unsigned int i = 0; i < n_bursts; ++i) {
     total_time += time_sequence[i];
   }
   compute_remaining_time();
 }
 
+const process::progress process::get_progress() const {
+  progress p;
+  p.current_time = current_time;
+  p.burst_index = burst_index;
+  p.burst_offset = burst_offset;
+  p.state = state;
+  p.remaining_time = remaining_time;
+  p.estimated_remaining_time = estimated_remaining_time;
+  p.last_estimated_burst_time = last_estimated_burst_time;
+  return p;
+}
+
+void process::set_progress(const progress &p) {
+  current_time = p.current_time;
+  burst_index = p.burst_index;
+  burst_offset = p.burst_offset;
+  state = p.state;
+  remaining_time = p.remaining_time;
+  estimated_remaining_time = p.estimated_remaining_time;
+  last_estimated_burst_time = p.last_estimated_burst_time;
+}
+
 const int process::proceed() {
   assert(current_time < total_time);
-  const int current = query_state(current_time);
-  const int next = query_state(++current_time);
+  const int current = state;
+  ++current_time;
+  // Move the cursor on to the next burst once this one is used up
+  if (++burst_offset == time_sequence[burst_index]) {
+    ++burst_index;
+    burst_offset = 0;
+  }
+  const int next = burst_state(burst_index);
   state = next;
   if (next == -1) {
     return -1;
   }
   // If switch between CPU burst and I/O burst
   if (current != next) {
-    if (next) {
-      // Reset turnaround time
-      turnaround_time = 0;
-      wait_time = 0;
-    }
     // Calculate remaining time
     remaining_time = 0;
     this->compute_remaining_time();
@@ -128,31 +168,23 @@ const int process::proceed() {
   return next;
 }
 
-const int process::query_state(int time) const {
-  int state = 0;
-  for (unsigned int i = 0; i < time_sequence.size(); ++i) {
-    if (time >= time_sequence[i])
-      time -= time_sequence[i];
-    else {
-      state = 1 - (i % 2);
-      break;
-    }
-    if (i == time_sequence.size() - 1) {
-      state = -1;
-      break;
-    }
+const int process::burst_state(const unsigned int i) const {
+  if (i >= n_bursts) {
+    return -1;
+  }
+  return 1 - (i % 2);
+}
+
+const int process::previous_state() const {
+  if (burst_offset > 0) {
+    return burst_state(burst_index);
   }
-  return state;
+  // Before the first ms counts as CPU
+  return burst_index > 0 ? burst_state(burst_index - 1) : 1;
 }
 
 void process::compute_remaining_time() {
-  int tmp_time = current_time;
-  for (unsigned int i = 0; i < time_sequence.size(); ++i) {
-    if (tmp_time >= time_sequence[i]) {
-      tmp_time -= time_sequence[i];
-    } else {
-      remaining_time = time_sequence[i] - tmp_time;
-      break;
-    }
+  if (burst_index < n_bursts) {
+    remaining_time = time_sequence[burst_index] - burst_offset;
   }
 }
@@ -1,11 +1,24 @@
 //  process.cpp
 /* This class represents a process
+Memory: sizeof(process) is 56 bytes on 64-bit Linux. The bursts are not
+part of it but live in the workload (see workload.h), 4 bytes per burst
+(about 400 bytes per process with the default generator, which draws
+1-100 CPU bursts per process) stored once for all simulators. Every
+scheduler keeps its own processes and adds about 120 bytes per process:
+72 for its latency (see schedule_algorithm.h), 8 each for the times it
+was queued and last stopped, 4 for its place in arrival order, 16 for
+its I/O timer entry and 8 for the ready queue, 8 more for the shortest
+first heap of SJF and SRT. That makes about 180 bytes per process per
+scheduler, plus what some policies keep per process on top (MLFQ levels,
+CFS and stride keys, the history of the window and median predictors).
  */
 #ifndef PROCESS
 #define PROCESS
 
 #include <assert.h>
+#include <cstdint>
 #include <iostream>
+#include <string>
 #include <vector>
 
 class process {
@@ -15,18 +28,24 @@ public:
   // Copy constructor
   process(const process &);
   /* Brief constructor:
-  A vector containing times for each burst is passed. The first
-  time is for CPU burst, then I/O burst, and so on. The last one
-  is also CPU burst, so the size must be odd.
+  An array containing times for each burst and its size are passed.
+  The first time is for CPU burst, then I/O burst, and so on. The last
+  one is also CPU burst, so the size must be odd. The array is not
+  copied and must outlive the process.
   */
-  process(const int, const char, const std::vector<int> &);
-  // Return the process ID, denoted by a capital letter
-  const char get_ID() const { return ID; };
+  process(const int, const uint32_t, const int *, const uint32_t);
+  // How IDs are shown: A-Z, AA, AB... or plain numbers
+  enum ID_format { LETTER_IDS, NUMBER_IDS };
+  static void set_ID_format(const ID_format f) { ID_style = f; };
+  // Return the process ID. IDs count up from 0 in generation order
+  const uint32_t get_ID() const { return ID; };
+  // Return the process ID as shown in the output
+  const std::string get_name() const { return name(ID); };
+  // How the process with the given ID is shown in the output
+  static const std::string name(const uint32_t);
   // Return whether the process is in CPU burst (1) or I/O burst (0)
   const int get_state() const { return state; };
   const int get_arrival_time() const { return arrival_time; };
-  const int get_wait_time() const { return wait_time; };
-  const int get_turnaround_time() const { return turnaround_time; };
   // Get remaining CPU burst for this burst. return 0 for blocked state
   const int get_remaining_time() const { return remaining_time; };
   // Get estimated remaining time that is set before. For SRT and SJF
@@ -43,61 +62,82 @@ public:
   const int get_remaining_CPU_bursts() const;
   // return whether this process is preempted
   const int preempted() const;
-  // Only for debugging. not changeable from outside
-  const std::vector<int> &get_time_sequence() const { return time_sequence; };
   // Set the estimated remaining time
   void set_estimated_remaining_time(const int t);
-  // reset wait time
-  void reset_wait_time() { wait_time = 0; };
   /* Run for 1 ms. Returns the state after running 1ms:
   1 for CPU and 0 for IO. If the preocess ends then return -1*/
   const int run_for_1ms();
-  /* Wait for 1 ms. increase wait_time and turnaround time
-  according to its state. Increase turnaround time only when
-  current time is at the beginning of the burst*/
-  const int wait_for_1ms(bool);
   /*If it's blocked then proceed 1ms. Returns the state after blocking:
   1 for CPU and 0 for IO. */
   const int block_for_1ms();
+  /* Same as calling run_for_1ms() ms times in a row. ms must not exceed
+  the remaining time of this burst.*/
+  const int run_for(const int ms);
+  /* Same as calling block_for_1ms() ms times in a row. ms must not
+  exceed the remaining time of this I/O burst.*/
+  const int block_for(const int ms);
   // Pinrt its burst time and io time
   void print();
   // Print arrival time and burst number only
-  void print_overview();
+  void print_overview(std::ostream &);
   // Reset everything of this process
   void reset();
+  // Everything about the process that changes as it runs, for checkpoints
+  struct progress {
+    int current_time;
+    unsigned int burst_index;
+    int burst_offset;
+    int state;
+    int remaining_time;
+    int estimated_remaining_time;
+    int last_estimated_burst_time;
+  };
+  const progress get_progress() const;
+  void set_progress(const progress &);
 
 private:
   /* Proceed 1ms for the process, either in running or blocked.
   Return the state after proceeding (1 for CPU 0 for IO)*/
   const int proceed();
-  // query state (1 for CPU, 0 for IO, -1 for end) given a time
-  const int query_state(int) const;
+  // State (1 for CPU, 0 for IO, -1 for end) of the i-th burst
+  const int burst_state(const unsigned int) const;
+  // State of the ms before current_time
+  const int previous_state() const;
   // Compute the remaining time.
   void compute_remaining_time();
   // The iterator indicating current position in the sequence.
   int current_time;
+  /* Cursor into time_sequence kept in step with current_time, so that
+  state queries do not rescan the sequence: the burst current_time falls
+  in and how far into that burst it is.*/
+  unsigned int burst_index;
+  int burst_offset;
   // state. 1 for CPU 0 for I/O -1 for end
   int state;
   // The arrival time
   int arrival_time;
+  // Process ID
+  uint32_t ID;
+  // An int sequence for this process, owned by the workload
+  const int *time_sequence;
+  uint32_t n_bursts;
   // The total time (excluding waiting)
   int total_time;
-  // Process ID
-  char ID;
-  // An int sequence for this process.
-  std::vector<int> time_sequence;
-  /* Wait time counter in ms for inquiry and output. Will be reset
-  after every CPU busrt! */
-  int wait_time;
-  /* Turnaournd time counter in ms for inquiry and output. Will be reset
-  after every CPU burst! */
-  int turnaround_time;
   // Remaining time for this CPU burst. 0 when blocked
   int remaining_time;
   // Estimated remaining time sor SRT and SJF
   int estimated_remaining_time;
   // tau_i-1
   int last_estimated_burst_time;
+  // Shared by all processes, set once before simulating
+  static ID_format ID_style;
 };
 
+/* The handle the policies, comparators and traces take. What is kept per
+process (the queues, the I/O timer, arrival order) holds 32-bit positions
+in the process vector instead, which never reallocates once built.*/
+typedef std::vector<process>::iterator process_ptr;
+// Simulated time in ms
+typedef int64_t sim_time;
+
 #endif
\ No newline at end of file
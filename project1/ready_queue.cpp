@@ -0,0 +1,365 @@
+#include "ready_queue.h"
+#include <algorithm>
+#include <stdlib.h>
+
+void index_list::push_back(std::vector<list_link> &links, const uint32_t i) {
+  links[i].prev = tail;
+  links[i].next = none;
+  if (tail == none) {
+    head = i;
+  } else {
+    links[tail].next = i;
+  }
+  tail = i;
+  ++n;
+}
+
+void index_list::push_front(std::vector<list_link> &links,
+                            const uint32_t i) {
+  links[i].prev = none;
+  links[i].next = head;
+  if (head == none) {
+    tail = i;
+  } else {
+    links[head].prev = i;
+  }
+  head = i;
+  ++n;
+}
+
+void index_list::pop_front(std::vector<list_link> &links) {
+  assert(n > 0);
+  head = links[head].next;
+  if (head == none) {
+    tail = none;
+  } else {
+    links[head].prev = none;
+  }
+  --n;
+}
+
+void index_list::splice(std::vector<list_link> &links, index_list &other) {
+  if (other.n == 0) {
+    return;
+  }
+  if (tail == none) {
+    head = other.head;
+  } else {
+    links[tail].next = other.head;
+    links[other.head].prev = tail;
+  }
+  tail = other.tail;
+  n += other.n;
+  other = index_list();
+}
+
+fifo_queue::fifo_queue(std::vector<process> &p)
+    : base(p.begin()), links(p.size()), queued(p.size(), false) {}
+
+void fifo_queue::push_back(process_ptr p) {
+  assert(!queued[p - base]);
+  queued[p - base] = true;
+  queue.push_back(links, p - base);
+}
+
+void fifo_queue::push_front(process_ptr p) {
+  assert(!queued[p - base]);
+  queued[p - base] = true;
+  queue.push_front(links, p - base);
+}
+
+void fifo_queue::pop_front() {
+  queued[queue.front()] = false;
+  queue.pop_front(links);
+}
+
+process_ptr fifo_queue::at(size_t i) const {
+  uint32_t p = queue.front();
+  for (; i > 0; --i) {
+    p = links[p].next;
+  }
+  return base + p;
+}
+
+void fifo_queue::snapshot(std::vector<process_ptr> &out) const {
+  out.clear();
+  for (uint32_t p = queue.front(); p != index_list::none; p = links[p].next) {
+    out.push_back(base + p);
+  }
+}
+
+indexed_heap_queue::indexed_heap_queue(std::vector<process> &p,
+                                       process_order less)
+    : base(p.begin()), less(less), keys(NULL), position(p.size(), -1) {
+  heap.reserve(p.size());
+}
+
+indexed_heap_queue::indexed_heap_queue(std::vector<process> &p,
+                                       const std::vector<int64_t> &keys)
+    : base(p.begin()), less(NULL), keys(&keys), position(p.size(), -1) {
+  heap.reserve(p.size());
+}
+
+void indexed_heap_queue::push_back(process_ptr p) {
+  assert(position[p - base] == -1);
+  heap.push_back(p - base);
+  position[p - base] = heap.size() - 1;
+  sift_up(heap.size() - 1);
+}
+
+void indexed_heap_queue::pop_front() {
+  assert(!heap.empty());
+  position[heap.front()] = -1;
+  const uint32_t last = heap.back();
+  heap.pop_back();
+  if (!heap.empty()) {
+    place(0, last);
+    sift_down(0);
+  }
+}
+
+void indexed_heap_queue::update(process_ptr p) {
+  const int i = position[p - base];
+  if (i == -1) {
+    return;
+  }
+  sift_up(i);
+  sift_down(position[p - base]);
+}
+
+void indexed_heap_queue::remove(process_ptr p) {
+  const int i = position[p - base];
+  assert(i != -1);
+  position[p - base] = -1;
+  const uint32_t last = heap.back();
+  heap.pop_back();
+  if ((size_t)i < heap.size()) {
+    place(i, last);
+    sift_up(i);
+    sift_down(position[last]);
+  }
+}
+
+void indexed_heap_queue::snapshot(std::vector<process_ptr> &out) const {
+  out.clear();
+  for (auto i : heap) {
+    out.push_back(base + i);
+  }
+  std::sort(out.begin(), out.end(), [this](process_ptr a, process_ptr b) {
+    return before(a - base, b - base);
+  });
+}
+
+void indexed_heap_queue::sift_up(size_t i) {
+  const uint32_t p = heap[i];
+  while (i > 0) {
+    const size_t parent = (i - 1) / 2;
+    if (!before(p, heap[parent])) {
+      break;
+    }
+    place(i, heap[parent]);
+    i = parent;
+  }
+  place(i, p);
+}
+
+void indexed_heap_queue::sift_down(size_t i) {
+  const uint32_t p = heap[i];
+  while (true) {
+    size_t child = 2 * i + 1;
+    if (child >= heap.size()) {
+      break;
+    }
+    if (child + 1 < heap.size() && before(heap[child + 1], heap[child])) {
+      ++child;
+    }
+    if (!before(heap[child], p)) {
+      break;
+    }
+    place(i, heap[child]);
+    i = child;
+  }
+  place(i, p);
+}
+
+void indexed_heap_queue::place(size_t i, uint32_t p) {
+  heap[i] = p;
+  position[p] = i;
+}
+
+multilevel_queue::multilevel_queue(std::vector<process> &p, const int levels)
+    : base(p.begin()), queues(levels), links(p.size()), level(p.size(), 0),
+      queued(p.size(), false), non_empty(0), n_queued(0) {
+  assert(levels > 0 && levels <= max_levels);
+}
+
+void multilevel_queue::push_back(process_ptr p) {
+  const int l = level[p - base];
+  assert(!queued[p - base]);
+  queued[p - base] = true;
+  queues[l].push_back(links, p - base);
+  non_empty |= (uint64_t)1 << l;
+  ++n_queued;
+}
+
+void multilevel_queue::push_front(process_ptr p) {
+  const int l = level[p - base];
+  assert(!queued[p - base]);
+  queued[p - base] = true;
+  queues[l].push_front(links, p - base);
+  non_empty |= (uint64_t)1 << l;
+  ++n_queued;
+}
+
+void multilevel_queue::pop_front() {
+  assert(!empty());
+  const int l = first();
+  queued[queues[l].front()] = false;
+  queues[l].pop_front(links);
+  if (queues[l].empty()) {
+    non_empty &= ~((uint64_t)1 << l);
+  }
+  --n_queued;
+}
+
+process_ptr multilevel_queue::at(size_t i) const {
+  for (auto &queue : queues) {
+    if (i < queue.size()) {
+      uint32_t p = queue.front();
+      for (; i > 0; --i) {
+        p = links[p].next;
+      }
+      return base + p;
+    }
+    i -= queue.size();
+  }
+  assert(false);
+  return base;
+}
+
+void multilevel_queue::snapshot(std::vector<process_ptr> &out) const {
+  out.clear();
+  for (auto &queue : queues) {
+    for (uint32_t p = queue.front(); p != index_list::none;
+         p = links[p].next) {
+      out.push_back(base + p);
+    }
+  }
+}
+
+void multilevel_queue::set_level(process_ptr p, const int l) {
+  assert(l >= 0 && l < (int)queues.size());
+  level[p - base] = l;
+}
+
+void multilevel_queue::boost() {
+  for (size_t l = 1; l < queues.size(); ++l) {
+    queues[0].splice(links, queues[l]);
+  }
+  std::fill(level.begin(), level.end(), 0);
+  non_empty = queues[0].empty() ? 0 : 1;
+}
+
+keyed_queue::keyed_queue(std::vector<process> &p,
+                         const std::vector<int64_t> &keys)
+    : base(p.begin()), keys(keys), queued_key(p.size(), 0),
+      heap(p, queued_key) {}
+
+void keyed_queue::push_back(process_ptr p) {
+  queued_key[p - base] = keys[p - base];
+  heap.push_back(p);
+}
+
+void keyed_queue::update(process_ptr p) {
+  if (!heap.contains(p)) {
+    return;
+  }
+  queued_key[p - base] = keys[p - base];
+  heap.update(p);
+}
+
+lottery_queue::lottery_queue(std::vector<process> &p,
+                             const std::vector<int> &tickets, const int seed)
+    : base(p.begin()), tickets(tickets), sums(p.size() + 1, 0),
+      queued(p.size(), false), n_queued(0), total(0), winner(-1) {
+  random_state[0] = 0x330E;
+  random_state[1] = seed & 0xFFFF;
+  random_state[2] = (seed >> 16) & 0xFFFF;
+}
+
+void lottery_queue::push_back(process_ptr p) {
+  const size_t i = p - base;
+  assert(!queued[i] && tickets[i] > 0);
+  queued[i] = true;
+  ++n_queued;
+  add(i, tickets[i]);
+  winner = -1;
+}
+
+process_ptr lottery_queue::front() const {
+  assert(n_queued > 0);
+  if (winner == -1) {
+    winner = find(std::min<int64_t>(erand48(random_state) * total, total - 1));
+  }
+  return base + winner;
+}
+
+void lottery_queue::pop_front() {
+  const size_t i = front() - base;
+  queued[i] = false;
+  --n_queued;
+  add(i, -tickets[i]);
+  winner = -1;
+}
+
+process_ptr lottery_queue::at(size_t i) const {
+  for (size_t j = 0; j < queued.size(); ++j) {
+    if (queued[j] && i-- == 0) {
+      return base + j;
+    }
+  }
+  assert(false);
+  return base;
+}
+
+void lottery_queue::snapshot(std::vector<process_ptr> &out) const {
+  // Not front(), which would draw and so change the schedule
+  out.clear();
+  for (size_t j = 0; j < queued.size(); ++j) {
+    if (queued[j]) {
+      out.push_back(base + j);
+    }
+  }
+}
+
+bool lottery_queue::draw(const int64_t extra) {
+  const int64_t t = erand48(random_state) * (total + extra);
+  if (t >= total) {
+    return false;
+  }
+  winner = find(t);
+  return true;
+}
+
+void lottery_queue::add(size_t i, const int64_t delta) {
+  total += delta;
+  for (++i; i < sums.size(); i += i & -i) {
+    sums[i] += delta;
+  }
+}
+
+size_t lottery_queue::find(int64_t t) const {
+  // Walk down from the largest power of two, skipping whole subtrees
+  size_t i = 0;
+  size_t step = 1;
+  while (step * 2 < sums.size()) {
+    step *= 2;
+  }
+  for (; step > 0; step /= 2) {
+    if (i + step < sums.size() && sums[i + step] <= t) {
+      i += step;
+      t -= sums[i];
+    }
+  }
+  return i;
+}
@@ -0,0 +1,258 @@
+/* Ready queues used by the schedulers. process_queue is the interface
+the schedulers talk to; fifo_queue keeps arrival order (FCFS, RR),
+indexed_heap_queue keeps the processes ordered by a comparator (SJF, SRT)
+or by a number kept outside the processes (stride), multilevel_queue
+keeps one FIFO per priority level (MLFQ), keyed_queue keeps them ordered
+by a number kept outside the processes as well (CFS) and lottery_queue
+draws the next process at random (lottery).
+
+All of them hold processes by their 32-bit position in the process
+vector, in storage sized for every process up front, so queueing never
+allocates.
+ */
+#ifndef READY_QUEUE
+#define READY_QUEUE
+
+#include "process.h"
+#include <cstdint>
+#include <vector>
+
+// Strict ordering of two processes. Must not consider two processes equal
+typedef bool (*process_order)(process_ptr, process_ptr);
+
+class process_queue {
+public:
+  virtual ~process_queue() {}
+  // Add a process. A process can be in the queue only once
+  virtual void push_back(process_ptr) = 0;
+  // Add a process to the head. Same as push_back for ordered queues
+  virtual void push_front(process_ptr) = 0;
+  // The process to run next. The queue must not be empty
+  virtual process_ptr front() const = 0;
+  // Remove the process returned by front()
+  virtual void pop_front() = 0;
+  virtual bool empty() const = 0;
+  virtual size_t size() const = 0;
+  // Whether the process is in the queue
+  virtual bool contains(process_ptr) const = 0;
+  /* Access the i-th process in storage order, which is not necessarily
+  the order they will be run in. For walking over all processes.*/
+  virtual process_ptr at(size_t) const = 0;
+  // Restore the order after the key of a queued process has changed
+  virtual void update(process_ptr) = 0;
+  // Copy the processes into the vector in the order they will be run
+  virtual void snapshot(std::vector<process_ptr> &) const = 0;
+};
+
+// Neighbours of a process on an index_list
+struct list_link {
+  uint32_t prev;
+  uint32_t next;
+};
+
+/* Doubly linked list of processes, by position, threaded through an
+array of links with one per process. Lists can share the links as long
+as a process is on at most one of them.*/
+class index_list {
+public:
+  // End of the list
+  static const uint32_t none = UINT32_MAX;
+  index_list() : head(none), tail(none), n(0) {}
+  void push_back(std::vector<list_link> &, const uint32_t);
+  void push_front(std::vector<list_link> &, const uint32_t);
+  // Remove the first process. The list must not be empty
+  void pop_front(std::vector<list_link> &);
+  // Move the processes of other to the end of this list
+  void splice(std::vector<list_link> &, index_list &other);
+  // The first process, none when empty. Walk on with links[i].next
+  const uint32_t front() const { return head; };
+  const bool empty() const { return n == 0; };
+  const size_t size() const { return n; };
+
+private:
+  uint32_t head;
+  uint32_t tail;
+  size_t n;
+};
+
+class fifo_queue : public process_queue {
+public:
+  fifo_queue(std::vector<process> &);
+  void push_back(process_ptr);
+  void push_front(process_ptr);
+  process_ptr front() const { return base + queue.front(); };
+  void pop_front();
+  bool empty() const { return queue.empty(); };
+  size_t size() const { return queue.size(); };
+  bool contains(process_ptr p) const { return queued[p - base]; };
+  process_ptr at(size_t) const;
+  // Order never depends on a key
+  void update(process_ptr) {}
+  void snapshot(std::vector<process_ptr> &) const;
+
+private:
+  process_ptr base;
+  index_list queue;
+  std::vector<list_link> links;
+  std::vector<bool> queued;
+};
+
+/* Binary heap that also remembers where each process sits in it, so that
+a queued process can be moved after its key changed in O(log n).
+Processes are identified by their position in the process vector.*/
+class indexed_heap_queue : public process_queue {
+public:
+  indexed_heap_queue(std::vector<process> &, process_order);
+  // Ordered by keys[position of the process] instead, ties broken by ID
+  indexed_heap_queue(std::vector<process> &, const std::vector<int64_t> &keys);
+  void push_back(process_ptr);
+  void push_front(process_ptr p) { push_back(p); };
+  process_ptr front() const { return base + heap.front(); };
+  void pop_front();
+  bool empty() const { return heap.empty(); };
+  size_t size() const { return heap.size(); };
+  bool contains(process_ptr p) const { return position[p - base] != -1; };
+  process_ptr at(size_t i) const { return base + heap[i]; };
+  void update(process_ptr);
+  void snapshot(std::vector<process_ptr> &) const;
+  // Take p out of the queue, wherever it is
+  void remove(process_ptr p);
+
+private:
+  // Move the entry at i towards the root/leaves until the heap is valid
+  void sift_up(size_t);
+  void sift_down(size_t);
+  // Put process p at i and remember its position
+  void place(size_t, uint32_t p);
+  // Whether process a runs before process b
+  bool before(uint32_t a, uint32_t b) const {
+    if (keys == NULL) {
+      return less(base + a, base + b);
+    }
+    const int64_t key_a = (*keys)[a], key_b = (*keys)[b];
+    return key_a < key_b || (key_a == key_b && a < b);
+  };
+  // The first process, to turn iterators into indices
+  process_ptr base;
+  // One of the two is used
+  process_order less;
+  const std::vector<int64_t> *keys;
+  std::vector<uint32_t> heap;
+  // Position of each process in the heap, -1 when not queued
+  std::vector<int> position;
+};
+
+/* One FIFO per priority level, level 0 running first. A bit mask of the
+non-empty levels finds the first one in O(1). Every process has a level,
+0 at first, and is queued on it. Processes are identified by their
+position in the process vector.*/
+class multilevel_queue : public process_queue {
+public:
+  static const int max_levels = 64;
+  multilevel_queue(std::vector<process> &, const int levels);
+  void push_back(process_ptr p);
+  void push_front(process_ptr p);
+  process_ptr front() const { return base + queues[first()].front(); };
+  void pop_front();
+  bool empty() const { return non_empty == 0; };
+  size_t size() const { return n_queued; };
+  bool contains(process_ptr p) const { return queued[p - base]; };
+  process_ptr at(size_t) const;
+  // Order never depends on a key
+  void update(process_ptr) {}
+  void snapshot(std::vector<process_ptr> &) const;
+  const int get_levels() const { return queues.size(); };
+  const int get_level(process_ptr p) const { return level[p - base]; };
+  // Change the level of a process that is not queued
+  void set_level(process_ptr, const int);
+  // Move every process to level 0. Queued ones keep their order
+  void boost();
+
+private:
+  // The first non-empty level. The queue must not be empty
+  const int first() const { return __builtin_ctzll(non_empty); };
+  process_ptr base;
+  // The levels share the links
+  std::vector<index_list> queues;
+  std::vector<list_link> links;
+  std::vector<int> level;
+  std::vector<bool> queued;
+  // Bit l is set when level l is not empty
+  uint64_t non_empty;
+  size_t n_queued;
+};
+
+/* Processes ordered by a key per process, ties broken by ID. The key of
+a process is read from keys when it is queued; a queued process whose key
+changes must be passed to update(). Processes are identified by their
+position in the process vector.*/
+class keyed_queue : public process_queue {
+public:
+  keyed_queue(std::vector<process> &, const std::vector<int64_t> &keys);
+  void push_back(process_ptr);
+  void push_front(process_ptr p) { push_back(p); };
+  process_ptr front() const { return heap.front(); };
+  void pop_front() { heap.pop_front(); };
+  bool empty() const { return heap.empty(); };
+  size_t size() const { return heap.size(); };
+  bool contains(process_ptr p) const { return heap.contains(p); };
+  process_ptr at(size_t i) const { return heap.at(i); };
+  void update(process_ptr);
+  void snapshot(std::vector<process_ptr> &out) const { heap.snapshot(out); };
+
+private:
+  process_ptr base;
+  const std::vector<int64_t> &keys;
+  // The key of each process when it was queued, which the heap is on
+  std::vector<int64_t> queued_key;
+  indexed_heap_queue heap;
+};
+
+/* Lottery among the queued processes: front() is a process drawn at
+random with a chance proportional to its tickets, and stays the same
+until the queue changes or draw() is called. The tickets of the queued
+processes are summed in a Fenwick tree, so a draw takes O(log n). The
+draws only depend on the seed. Processes are identified by their position
+in the process vector.*/
+class lottery_queue : public process_queue {
+public:
+  lottery_queue(std::vector<process> &, const std::vector<int> &tickets,
+                const int seed);
+  void push_back(process_ptr);
+  void push_front(process_ptr p) { push_back(p); };
+  /* Draws the next process the first time it is asked for after the
+  queue changed, so only the scheduling calls it.*/
+  process_ptr front() const;
+  void pop_front();
+  bool empty() const { return n_queued == 0; };
+  size_t size() const { return n_queued; };
+  bool contains(process_ptr p) const { return queued[p - base]; };
+  process_ptr at(size_t) const;
+  // Order never depends on a key
+  void update(process_ptr) {}
+  /* The processes by ID, since the next one is not known before the
+  draw. Draws nothing, so tracing the queue leaves the schedule alone.*/
+  void snapshot(std::vector<process_ptr> &) const;
+  /* Draw again, as if someone outside the queue held extra more
+  tickets. Returns false if they win; front() then stays as it was.*/
+  bool draw(const int64_t extra);
+
+private:
+  // Add delta tickets to the process at position i
+  void add(size_t i, const int64_t delta);
+  // Position of the process holding ticket t, 0 <= t < total
+  size_t find(int64_t t) const;
+  process_ptr base;
+  const std::vector<int> &tickets;
+  // Fenwick tree of the tickets of the queued processes, 1-based
+  std::vector<int64_t> sums;
+  std::vector<bool> queued;
+  size_t n_queued;
+  int64_t total;
+  // State of erand48
+  mutable unsigned short random_state[3];
+  // Position of the drawn process, -1 when a new one has to be drawn
+  mutable int winner;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "schedule_algorithm.h"
+#include "multicore.h"
 
 bool resolveTie(process_ptr i, process_ptr j) {
   return (i->get_ID() < j->get_ID());
@@ -26,218 +27,850 @@ bool ShorterRemainingTime(process_ptr a, process_ptr b) {
   }
 }
 
-schedule_algorithm::schedule_algorithm(const std::vector<process> &p,
-                                       const int t_cs)
-    : processes(p), t_cs(t_cs), time(0), running(processes.end()), wait_time(0),
-      n_wait(0), turnaround_time(0), n_cs(0), n_preemption(0) {
+bool ShorterActualTime(process_ptr a, process_ptr b) {
+  if (a->get_remaining_time() == b->get_remaining_time()) {
+    return resolveTie(a, b);
+  }
+  return a->get_remaining_time() < b->get_remaining_time();
+}
+
+bool EarlierArrival(process_ptr a, process_ptr b) {
+  if (a->get_arrival_time() == b->get_arrival_time()) {
+    return (resolveTie(a, b));
+  }
+  return a->get_arrival_time() < b->get_arrival_time();
+}
+
+// The state of every process of the workload, in ID order
+static std::vector<process> start_processes(const workload &jobs) {
+  // Processes point into the workload, so this allocates only once
+  std::vector<process> processes;
+  processes.reserve(jobs.size());
+  for (uint32_t i = 0; i < jobs.size(); ++i) {
+    processes.emplace_back(jobs.get_arrival_time(i), i, jobs.get_bursts(i),
+                           jobs.get_n_bursts(i));
+  }
+  return processes;
+}
+
+schedule_algorithm::schedule_algorithm(std::shared_ptr<const workload> p,
+                                       const int t_cs,
+                                       const std::string &name)
+    : jobs(p), processes(start_processes(*p)), out(&std::cout), name(name),
+      t_cs(t_cs), switch_costs(std::make_shared<fixed_switch_cost>(t_cs)),
+      time(0), started(false), cpu_state(-2),
+      pause_at(std::numeric_limits<sim_time>::max()), switch_time(0),
+      ready_queue(new fifo_queue(processes)), wait_clock(0), dispatched(0),
+      blocked(processes), io_clock(0), n_terminated(0), wait_time(0),
+      n_wait(0),
+      turnaround_time(0),
+      n_cs(0), n_preemption(0), stream_ahead(false), ahead_arrival(0),
+      n_streamed(0), streamed_CPU_time(0), streamed_CPU_bursts(0),
+      retired(NULL), stream_error(NULL) {
   assert(t_cs % 2 == 0);
+  running = processes.end();
+  last_out = processes.end();
+  stopped.assign(processes.size(), -1);
+  enqueued.resize(processes.size());
+  latency.assign(processes.size(), process_latency());
+  arrival_order.reserve(processes.size());
+  for (uint32_t i = 0; i < processes.size(); ++i) {
+    arrival_order.push_back(i);
+  }
+  std::sort(arrival_order.begin(), arrival_order.end(),
+            [this](const uint32_t a, const uint32_t b) {
+              return EarlierArrival(processes.begin() + a,
+                                    processes.begin() + b);
+            });
+  next_arrival = 0;
 }
 
 void schedule_algorithm::write_stats(std::ofstream &file) {
-  // compute CPU burst time
-  double CPU_burst_time = 0;
-  double CPU_num = 0;
-  for (auto i : processes) {
-    for (unsigned int j = 0; j < i.get_time_sequence().size(); ++j) {
-      if (j % 2 == 0) {
-        CPU_burst_time += i.get_time_sequence()[j];
-        CPU_num += 1;
-      }
-    }
+  const schedule_stats stats = get_stats();
+  // Output
+  file << std::setprecision(3) << std::fixed;
+  file << "-- average CPU burst time: " << stats.average_burst_time << " ms\n"
+       << "-- average wait time: " << stats.average_wait_time << " ms\n"
+       << "-- average turnaround time: " << stats.average_turnaround_time
+       << " ms\n"
+       << "-- total number of context switches: " << stats.context_switches
+       << "\n"
+       << "-- total number of preemptions: " << stats.preemptions << "\n"
+       << "-- time spent switching: " << stats.switch_time << " ms\n";
+  if (predictor != NULL) {
+    file << "-- burst estimates (" << predictor->get_name()
+         << "): mean absolute error " << stats.prediction_error
+         << " ms, bias " << stats.prediction_bias << " ms, "
+         << 100 * stats.misordered
+         << "% of dispatches out of shortest first order\n";
+  }
+  const char *names[3] = {"wait", "turnaround", "response"};
+  const latency_percentiles *percentiles[3] = {&stats.wait, &stats.turnaround,
+                                               &stats.response};
+  for (int i = 0; i < 3; ++i) {
+    file << "-- " << names[i] << " time percentiles: p50 "
+         << percentiles[i]->p50 << " ms, p90 " << percentiles[i]->p90
+         << " ms, p99 " << percentiles[i]->p99 << " ms, p99.9 "
+         << percentiles[i]->p999 << " ms, max " << percentiles[i]->max
+         << " ms\n";
   }
+  // Streamed runs wrote these as the processes terminated
+  for (size_t i = 0; stream == NULL && i < processes.size(); ++i) {
+    write_latency(file, i);
+  }
+}
 
-  // Output
+void schedule_algorithm::write_latency(std::ostream &file, const size_t i) {
+  const process_latency &l = latency[i];
+  const double bursts = std::max(l.bursts, 1);
   file << std::setprecision(3) << std::fixed;
-  file << "-- average CPU burst time: " << CPU_burst_time / CPU_num << " ms\n"
-       << "-- average wait time: " << wait_time / CPU_num << " ms\n"
-       << "-- average turnaround time: " << turnaround_time / CPU_num << " ms\n"
-       << "-- total number of context switches: " << n_cs << "\n"
-       << "-- total number of preemptions: " << n_preemption << "\n";
+  file << "-- process " << processes[i].get_name() << ": " << l.bursts
+       << " bursts, wait " << l.total_wait / bursts << " ms (max "
+       << l.max_wait << " ms), turnaround " << l.total_turnaround / bursts
+       << " ms (max " << l.max_turnaround << " ms), response "
+       << l.total_response / bursts << " ms (max " << l.max_response
+       << " ms)\n";
+}
+
+// The percentiles schedule_stats reports of h
+static latency_percentiles percentiles(const latency_histogram &h) {
+  latency_percentiles p;
+  p.p50 = h.percentile(50);
+  p.p90 = h.percentile(90);
+  p.p99 = h.percentile(99);
+  p.p999 = h.percentile(99.9);
+  p.max = h.get_max();
+  return p;
+}
+
+const schedule_stats schedule_algorithm::get_stats() const {
+  // CPU burst time comes with the workload, or with the stream
+  const double CPU_burst_time =
+      stream != NULL ? streamed_CPU_time : jobs->get_CPU_time();
+  const double CPU_num =
+      stream != NULL ? streamed_CPU_bursts : jobs->get_n_CPU_bursts();
+  schedule_stats stats;
+  stats.average_burst_time = CPU_burst_time / CPU_num;
+  stats.average_wait_time = wait_time / CPU_num;
+  stats.average_turnaround_time = turnaround_time / CPU_num;
+  stats.context_switches = n_cs;
+  stats.preemptions = n_preemption;
+  stats.migrations = 0;
+  stats.utilization = 0;
+  stats.switch_time = switch_time;
+  stats.prediction_error = stats.prediction_bias = stats.misordered = 0;
+  stats.wait = percentiles(wait_histogram);
+  stats.turnaround = percentiles(turnaround_histogram);
+  stats.response = percentiles(response_histogram);
+  if (predictor != NULL) {
+    const prediction_stats &p = predictor->get_stats();
+    if (p.bursts > 0) {
+      stats.prediction_error = (double)p.absolute_error / p.bursts;
+      stats.prediction_bias = (double)p.error / p.bursts;
+    }
+    if (p.dispatches > 0) {
+      stats.misordered = (double)p.misordered / p.dispatches;
+    }
+  }
+  return stats;
 }
 
 void schedule_algorithm::print_overview() {
-  for (auto i : processes) {
-    i.print_overview();
+  // Streamed processes are shown as they arrive
+  if (out == NULL || stream != NULL) {
+    return;
+  }
+  for (auto &i : processes) {
+    i.print_overview(*out);
   }
 }
 
 void schedule_algorithm::context_switch(process_ptr process_in) {
-  // Calculate turnaround time for process that is exiting
+  const int out_ms = running != processes.end() ? switch_out_cost(running) : 0;
   if (running != processes.end()) {
-    turnaround_time += t_cs / 2;
+    show_state(running, TIMELINE_SWITCH_OUT, time);
+    show_cpu(0, TIMELINE_SWITCH_OUT, running, time);
+  }
+  // Calculate turnaround time for process that is exiting: the ms it ran
+  // since it was switched in and the first half of this switch
+  if (running != processes.end()) {
+    add_turnaround(running, time - dispatched + out_ms);
+    if (running->get_state() != 1) {
+      complete_burst(running);
+    }
   }
 
   if (running != processes.end() && running->get_state() == 0) {
-    std::stringstream event;
-    event << "Process " << running->get_ID()
-          << " switching out of CPU; will block on I/O until time "
-          << (running->get_remaining_time() + time + t_cs / 2) << "ms";
-    print_event(event.str());
+    TRACE_EVENT(TRACE_BLOCK, running->get_ID(),
+                running->get_remaining_time() + time + out_ms);
   }
 
   bool process_in_wait = false;
-  // Check if this process_in is in ready queue
-  if (process_in == *(ready_queue.begin())) {
+  /* Check if this process_in is in ready queue. It is usually the head,
+  but a process SRT lets preempt can be queued behind a shorter one. */
+  if (process_in != processes.end() && ready_queue->contains(process_in)) {
     process_in_wait = true;
   }
 
+  // The ms the switch is decided on is the first of the switch
   ++time;
-  int start_time = 1;
   // First half of context switch
-  for (int i = start_time; i < t_cs / 2; i++) {
-    if (running == processes.end()) {
-      break;
-    } else {
-      start_time = 0;
-    }
-    // check if any new processes have the same arrival time.
-    check_arrival();
-    // Process_out is not in the ready queue for the first half
-    running->wait_for_1ms(false);
-    // Process in I/O burst proceed for t_cs
-    do_blocking();
-    perform_add_to_ready_queue();
-    // Processes in ready queue wait for t_cs
-    do_waiting();
-    time++;
-  }
-
   if (running != processes.end()) {
+    switch_for(out_ms - 1);
     // Remove the running process
     // Determine whether add the running process to ready_queue
     // or block on I/O, or terminate it.
     if (running->get_state() == 1) {
       prepare_add_to_ready_queue(running);
+      show_state(running, TIMELINE_READY, time);
     } else if (running->get_state() == 0) {
-      blocked.insert(running);
+      blocked.add(running, io_clock + running->get_remaining_time());
+      show_state(running, TIMELINE_IO, time);
     } else if (running->get_state() == -1) {
-      terminated.insert(running);
+      show_state(running, TIMELINE_IDLE, time);
+      ++n_terminated;
+      if (stream != NULL) {
+        retire(running);
+      }
     }
+    show_counts();
   }
+  // Whether the second half still has to simulate its first ms
+  const bool first_ms = running != processes.end();
 
   // Check if the process in has changed since the switch out
   if (process_in == processes.end()) {
+    if (running != processes.end()) {
+      show_cpu(0, TIMELINE_IDLE, running, time);
+    }
     running = processes.end();
     return;
   }
 
-  // Note extra turnaround time should be added if this is NOT
-  // the initial context switch!
-  for (int i = start_time; i < t_cs / 2; i++) {
-    // check if any new processes have the same arrival time.
+  /* The process in is taken on the first ms of the second half. After a
+  switch out, the processes that become ready on that ms are queued
+  before it is taken.*/
+  if (first_ms) {
     check_arrival();
-    // Process in I/O burst proceed for t_cs
     do_blocking();
-    if (i > start_time || start_time == 0) {
-      perform_add_to_ready_queue();
-    }
-    // Do these i the first loop
-    if (i == start_time) {
-      if (process_in_wait) {
-        // Check if the process in has changed since the switch out
-        if (process_in != *(ready_queue.begin())) {
-          process_in = *(ready_queue.begin());
-          // wait_time -= process_in->get_wait_time();
-          // turnaround_time -= process_in->get_wait_time();
-        }
-        ready_queue.pop_front();
-      }
-      // Replace the running process
-      running = process_in;
-      // Calculate time for incoming process
-      turnaround_time += t_cs / 2;
-    } else {
-      // Process_in is not in the ready queue for the second half
-      running->wait_for_1ms(false);
-    }
-    if (i == start_time && start_time == 1) {
-      perform_add_to_ready_queue();
+    perform_add_to_ready_queue();
+  }
+  if (process_in_wait) {
+    // Check if the process in has changed since the switch out
+    if (process_in != ready_queue->front()) {
+      process_in = ready_queue->front();
     }
-    // Processes in ready queue wait for t_cs
+    dequeue();
+  }
+  const int in_ms = switch_in_cost(process_in, last_out);
+  // Replace the running process
+  running = process_in;
+  // Calculate time for incoming process
+  add_turnaround(running, in_ms);
+  if (!first_ms && in_ms > 1) {
+    check_arrival();
+    do_blocking();
+    perform_add_to_ready_queue();
+  }
+  if (first_ms || in_ms > 1) {
+    // Processes in ready queue wait for the switch
     do_waiting();
     time++;
   }
-  std::stringstream event;
+  switch_for(in_ms - (first_ms ? 1 : 2));
+  ++n_cs;
+  dispatched = time;
+  show_state(running, TIMELINE_SWITCH_IN, time - in_ms);
+  show_cpu(0, TIMELINE_SWITCH_IN, running, time - in_ms);
+  show_state(running, TIMELINE_RUNNING, time);
+  show_cpu(0, TIMELINE_RUNNING, running, time);
+  record_response(running,
+                  latency[running - processes.begin()].wait + in_ms);
   if (!running->preempted()) {
-    event << "Process " << running->get_ID() << " started using the CPU for "
-          << running->get_remaining_time() << "ms burst";
+    TRACE_EVENT(TRACE_START_BURST, running->get_ID(),
+                running->get_remaining_time());
   } else {
-    event << "Process " << running->get_ID() << " started using the CPU with "
-          << running->get_remaining_time() << "ms remaining";
+    TRACE_EVENT(TRACE_RESUME, running->get_ID(), running->get_remaining_time());
   }
-  ++n_cs;
-  print_event(event.str());
 }
 
-void schedule_algorithm::check_arrival() {
-  for (auto itr = processes.begin(); itr != processes.end(); ++itr) {
-    if (itr->get_arrival_time() == time) {
-      prepare_add_to_ready_queue(itr);
+void schedule_algorithm::switch_for(sim_time ticks) {
+  // No process runs, so waiting is the same for every ms
+  assert(running != processes.end());
+  while (ticks > 0) {
+    const sim_time quiet = quiet_queue_ticks(ticks);
+    if (quiet > 0) {
+      io_clock += quiet;
+      wait_clock += quiet;
+      time += quiet;
+      ticks -= quiet;
+      continue;
     }
+    // check if any new processes have the same arrival time.
+    check_arrival();
+    // Process in I/O burst proceed for the switch
+    do_blocking();
+    perform_add_to_ready_queue();
+    // Processes in ready queue wait for the switch
+    do_waiting();
+    time++;
+    --ticks;
   }
-  for (auto itr = blocked.begin(); itr != blocked.end(); ++itr) {
-    // If the I/O time is end then move it to ready_queue
-    if ((*itr)->get_state() == 1) {
-      blocked.erase(itr);
-      prepare_add_to_ready_queue(*itr);
-    }
+}
+
+int schedule_algorithm::switch_out_cost(process_ptr p) {
+  const int ms = std::max(1, switch_costs->out());
+  stopped[p - processes.begin()] = time;
+  last_out = p;
+  switch_time += ms;
+  return ms;
+}
+
+int schedule_algorithm::switch_in_cost(process_ptr p, process_ptr last) {
+  const sim_time stop = stopped[p - processes.begin()];
+  const int ms =
+      std::max(1, switch_costs->in(stop < 0 ? -1 : time - stop, p == last));
+  switch_time += ms;
+  return ms;
+}
+
+void schedule_algorithm::check_arrival() {
+  skip_past_arrivals();
+  // Do not consume them, since a tick can be checked more than once
+  for (size_t i = next_arrival;
+       i < arrival_order.size() && arrival(i)->get_arrival_time() == time;
+       ++i) {
+    prepare_add_to_ready_queue(arrival(i));
+  }
+  // If the I/O time is end then move it to ready_queue
+  while (!blocked.empty() && blocked.next() <= io_clock) {
+    woken.push_back(blocked.pop());
+  }
+  std::sort(woken.begin(), woken.end(), resolveTie);
+  for (auto i : woken) {
+    // Bring the process to the end of its I/O burst
+    i->block_for(i->get_remaining_time());
+    prepare_add_to_ready_queue(i);
+  }
+  woken.clear();
+}
+
+void schedule_algorithm::skip_past_arrivals() {
+  if (stream != NULL) {
+    admit_arrivals();
+  }
+  while (next_arrival < arrival_order.size() &&
+         arrival(next_arrival)->get_arrival_time() < time) {
+    ++next_arrival;
   }
 }
 
 void schedule_algorithm::do_waiting() {
-  for (auto itr = ready_queue.begin(); itr != ready_queue.end(); ++itr) {
-    if (running == processes.end() && itr == ready_queue.begin()) {
-      continue;
-    }
-    (*itr)->wait_for_1ms(true);
-    wait_time += 1;
-    turnaround_time += 1;
+  ++wait_clock;
+  // The head does not wait while the CPU is idle, it is about to run
+  if (running == processes.end() && !ready_queue->empty()) {
+    ++enqueued[ready_queue->front() - processes.begin()];
   }
 }
 
-void schedule_algorithm::do_blocking() {
-  for (auto itr = blocked.begin(); itr != blocked.end(); ++itr) {
-    (*itr)->block_for_1ms();
+void schedule_algorithm::enqueue(process_ptr p, const bool front) {
+  enqueued[p - processes.begin()] = wait_clock;
+  if (front) {
+    ready_queue->push_front(p);
+  } else {
+    ready_queue->push_back(p);
+  }
+  if (shortest != NULL) {
+    shortest->push_back(p);
   }
+  show_state(p, TIMELINE_READY, time);
+  show_counts();
+}
+
+void schedule_algorithm::dequeue() {
+  process_ptr p = ready_queue->front();
+  ready_queue->pop_front();
+  score_dispatch(p, shortest.get());
+  show_counts();
+  const sim_time waited = wait_clock - enqueued[p - processes.begin()];
+  add_wait(p, waited);
+  add_turnaround(p, waited);
 }
 
+void schedule_algorithm::add_wait(process_ptr p, const sim_time ms) {
+  wait_time += ms;
+  latency[p - processes.begin()].wait += ms;
+}
+
+void schedule_algorithm::add_turnaround(process_ptr p, const sim_time ms) {
+  turnaround_time += ms;
+  latency[p - processes.begin()].turnaround += ms;
+}
+
+void schedule_algorithm::record_response(process_ptr p, const sim_time ms) {
+  process_latency &l = latency[p - processes.begin()];
+  if (l.responded) {
+    return;
+  }
+  l.responded = true;
+  l.total_response += ms;
+  l.max_response = std::max(l.max_response, ms);
+  response_histogram.record(ms);
+}
+
+void schedule_algorithm::complete_burst(process_ptr p) {
+  process_latency &l = latency[p - processes.begin()];
+  ++l.bursts;
+  l.total_wait += l.wait;
+  l.max_wait = std::max(l.max_wait, l.wait);
+  l.total_turnaround += l.turnaround;
+  l.max_turnaround = std::max(l.max_turnaround, l.turnaround);
+  wait_histogram.record(l.wait);
+  turnaround_histogram.record(l.turnaround);
+  l.wait = 0;
+  l.turnaround = 0;
+  l.responded = false;
+}
+
+void schedule_algorithm::start_estimate(process_ptr p) {
+  p->set_estimated_remaining_time(predictor->first(p - processes.begin()));
+}
+
+void schedule_algorithm::next_estimate(process_ptr p) {
+  p->set_estimated_remaining_time(predictor->next(
+      p - processes.begin(), p->get_last_estimated_burst_time(),
+      p->get_last_burst_time()));
+}
+
+void schedule_algorithm::score_estimate(process_ptr p) {
+  predictor->score(p->get_last_estimated_burst_time(),
+                   p->get_last_burst_time());
+}
+
+void schedule_algorithm::score_dispatch(process_ptr p,
+                                        indexed_heap_queue *shortest) {
+  if (shortest == NULL) {
+    return;
+  }
+  /* The shortest burst left, unless it ties with p, or its estimate does
+  and p only ran first by ID.*/
+  process_ptr first = shortest->front();
+  predictor->score_dispatch(
+      first->get_remaining_time() < p->get_remaining_time() &&
+      first->get_estimated_remaining_time() !=
+          p->get_estimated_remaining_time());
+  shortest->remove(p);
+}
+
+void schedule_algorithm::do_blocking() { ++io_clock; }
+
 void schedule_algorithm::prepare_add_to_ready_queue(
     process_ptr process_to_add) {
   pre_ready_queue.push_back(process_to_add);
 };
 
-void schedule_algorithm::print_event(std::string event) {
-  if (0) {
-    std::cout << "time " << time << "ms: " << event << " [Q";
-    for (auto i : ready_queue) {
-      std::cout << " " << i->get_ID();
+const sim_time schedule_algorithm::quiet_ticks(const sim_time limit) {
+  sim_time ticks = quiet_queue_ticks(limit);
+  // End of the current CPU burst
+  if (running != processes.end()) {
+    ticks = std::min<sim_time>(ticks, running->get_remaining_time());
+  }
+  // Nothing is going to happen at all, so there is nothing to jump to
+  if (ticks == std::numeric_limits<sim_time>::max()) {
+    return 0;
+  }
+  // Runs stopping early stop right on time
+  if (time < pause_at) {
+    ticks = std::min(ticks, pause_at - time);
+  }
+  return ticks;
+}
+
+const sim_time schedule_algorithm::quiet_queue_ticks(const sim_time limit) {
+  if (!pre_ready_queue.empty()) {
+    return 0;
+  }
+  sim_time ticks = limit;
+  // Next arrival
+  skip_past_arrivals();
+  if (next_arrival < arrival_order.size()) {
+    ticks = std::min<sim_time>(
+        ticks, arrival(next_arrival)->get_arrival_time() - time);
+  } else if (stream_ahead && stream_error == NULL) {
+    ticks = std::min<sim_time>(ticks, ahead_arrival - time);
+  }
+  // Next I/O completion
+  if (!blocked.empty()) {
+    if (blocked.next() <= io_clock) {
+      return 0;
     }
-    if (ready_queue.size() == 0)
-      std::cout << " <empty>";
-    std::cout << "]\n";
+    ticks = std::min(ticks, blocked.next() - io_clock);
   }
+  return ticks;
 }
 
-FCFS_scheduling::FCFS_scheduling(const std::vector<process> &p, const int t_cs)
-    : schedule_algorithm(p, t_cs) {}
+const int schedule_algorithm::fast_forward(const sim_time ticks) {
+  io_clock += ticks;
+  // The head is never skipped by do_waiting here since the CPU is busy
+  // whenever the ready queue is not empty
+  assert(ready_queue->empty() || running != processes.end());
+  wait_clock += ticks;
+  int state = -2;
+  if (running != processes.end()) {
+    state = running->run_for(ticks);
+  }
+  time += ticks;
+  return state;
+}
+
+const bool schedule_algorithm::all_terminated() const {
+  if (stream != NULL) {
+    return stream_error != NULL ||
+           (!stream_ahead && n_terminated == n_streamed);
+  }
+  return n_terminated == processes.size();
+}
+
+void schedule_algorithm::stream_from(std::unique_ptr<process_stream> s,
+                                     std::ostream *retired) {
+  stream = std::move(s);
+  this->retired = retired;
+  arrival_order.clear();
+  next_arrival = 0;
+  // The first slots are used first
+  free_slots.clear();
+  for (auto p = processes.rbegin(); p != processes.rend(); ++p) {
+    free_slots.push_back(p.base() - 1);
+  }
+  slot_bursts.resize(processes.size());
+  stream_ahead = stream->next(ahead_arrival, ahead_bursts);
+  stream_error = stream->get_error();
+}
+
+void schedule_algorithm::admit_arrivals() {
+  while (stream_ahead && ahead_arrival <= time && stream_error == NULL) {
+    if (free_slots.empty()) {
+      stream_error = "has more processes live at once than there are slots";
+      return;
+    }
+    process_ptr p = free_slots.back();
+    free_slots.pop_back();
+    const size_t i = p - processes.begin();
+    // The bursts stay in the slot while the process is live
+    slot_bursts[i].swap(ahead_bursts);
+    const std::vector<int> &bursts = slot_bursts[i];
+    *p = process(ahead_arrival, n_streamed++, bursts.data(), bursts.size());
+    for (size_t j = 0; j < bursts.size(); j += 2) {
+      streamed_CPU_time += bursts[j];
+    }
+    streamed_CPU_bursts += bursts.size() / 2 + 1;
+    enqueued[i] = 0;
+    latency[i] = process_latency();
+    stopped[i] = -1;
+    // Processes that arrived before are not looked at again
+    arrival_order.erase(arrival_order.begin(),
+                        arrival_order.begin() + next_arrival);
+    next_arrival = 0;
+    arrival_order.push_back(i);
+    if (out != NULL) {
+      p->print_overview(*out);
+    }
+    stream_ahead = stream->next(ahead_arrival, ahead_bursts);
+    stream_error = stream->get_error();
+  }
+}
+
+void schedule_algorithm::retire(process_ptr p) {
+  if (retired != NULL) {
+    write_latency(*retired, p - processes.begin());
+  }
+  // The next process in the slot is not the one that ran last
+  if (last_out == p) {
+    last_out = processes.end();
+  }
+  free_slots.push_back(p);
+}
+
+void schedule_algorithm::trace_event(const trace_kind kind,
+                                     const uint32_t pid, const int64_t value,
+                                     const uint32_t other) {
+  trace_record r;
+  r.time = time;
+  r.value = value;
+  r.pid = pid;
+  r.other = other;
+  r.kind = kind;
+  ready_queue->snapshot(trace_queue);
+  trace.record(r, trace_queue);
+}
+
+void schedule_algorithm::dump_trace() {
+  if (out != NULL) {
+    trace.dump(*out, name);
+  }
+}
+
+void schedule_algorithm::run_until(const sim_time t) {
+  pause_at = t;
+  run();
+  pause_at = std::numeric_limits<sim_time>::max();
+}
+
+/* Checkpoints are, in the byte order of the machine that wrote them:
+magic "CPUSIMCK", version, algorithm name, the size, CPU time and number
+of CPU bursts of the workload, the clocks and counters, the progress and
+latency of every process, the ready queue front first, the processes
+about to be queued and the blocked ones with their wake ticks, the
+histograms and last the state of the policy.*/
+static const char checkpoint_magic[8] = {'C', 'P', 'U', 'S',
+                                         'I', 'M', 'C', 'K'};
+static const uint32_t checkpoint_version = 1;
+
+// Processes are saved by their index, -1 for none
+static std::vector<int32_t> indices(const std::vector<process> &processes,
+                                    const std::vector<process_ptr> &list) {
+  std::vector<int32_t> out;
+  out.reserve(list.size());
+  for (auto p : list) {
+    out.push_back(p == processes.end() ? -1 : p - processes.begin());
+  }
+  return out;
+}
+
+// Whether every index is one of n processes, or -1 if none is allowed
+static bool valid_indices(const std::vector<int32_t> &list, const size_t n,
+                          const bool none) {
+  for (auto i : list) {
+    if (i < (none ? -1 : 0) || i >= (int64_t)n) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool schedule_algorithm::save(std::vector<char> &out) const {
+  std::vector<char> policy;
+  snapshot_writer policy_writer(policy);
+  if (stream != NULL || !save_policy(policy_writer)) {
+    return false;
+  }
+  out.clear();
+  snapshot_writer w(out);
+  w.put(checkpoint_magic);
+  w.put(checkpoint_version);
+  w.put_vector(std::vector<char>(name.begin(), name.end()));
+  w.put(jobs->size());
+  w.put(jobs->get_CPU_time());
+  w.put(jobs->get_n_CPU_bursts());
+  w.put(started);
+  w.put(cpu_state);
+  w.put(time);
+  w.put(wait_clock);
+  w.put(dispatched);
+  w.put(io_clock);
+  w.put(switch_time);
+  w.put<uint64_t>(next_arrival);
+  w.put<uint64_t>(n_terminated);
+  w.put<int32_t>(running == processes.end() ? -1 : running - processes.begin());
+  w.put<int32_t>(last_out == processes.end() ? -1
+                                             : last_out - processes.begin());
+  w.put(wait_time);
+  w.put(n_wait);
+  w.put(turnaround_time);
+  w.put(n_cs);
+  w.put(n_preemption);
+  std::vector<process::progress> progress;
+  progress.reserve(processes.size());
+  for (auto &p : processes) {
+    progress.push_back(p.get_progress());
+  }
+  w.put_vector(progress);
+  w.put_vector(stopped);
+  w.put_vector(enqueued);
+  w.put_vector(latency);
+  std::vector<process_ptr> queue;
+  ready_queue->snapshot(queue);
+  w.put_vector(indices(processes, queue));
+  w.put_vector(indices(processes, pre_ready_queue));
+  std::vector<sim_time> wakes;
+  blocked.snapshot(wakes, queue);
+  w.put_vector(wakes);
+  w.put_vector(indices(processes, queue));
+  wait_histogram.save(w);
+  turnaround_histogram.save(w);
+  response_histogram.save(w);
+  w.put_vector(policy);
+  return true;
+}
+
+bool schedule_algorithm::restore(const std::vector<char> &in) {
+  snapshot_reader r(in);
+  char magic[sizeof(checkpoint_magic)];
+  uint32_t version;
+  std::vector<char> saved_name;
+  uint32_t size;
+  int64_t CPU_time, n_CPU_bursts;
+  if (stream != NULL || !r.get(magic) ||
+      memcmp(magic, checkpoint_magic, sizeof(magic)) != 0 || !r.get(version) ||
+      version != checkpoint_version || !r.get_vector(saved_name) ||
+      std::string(saved_name.begin(), saved_name.end()) != name ||
+      !r.get(size) || size != jobs->size() || !r.get(CPU_time) ||
+      CPU_time != jobs->get_CPU_time() || !r.get(n_CPU_bursts) ||
+      n_CPU_bursts != jobs->get_n_CPU_bursts()) {
+    return false;
+  }
+  // Everything is read and checked before anything is changed
+  bool saved_started = false;
+  int saved_state = 0;
+  sim_time saved_time = 0, saved_wait_clock = 0, saved_dispatched = 0,
+           saved_io_clock = 0, saved_switch_time = 0;
+  uint64_t saved_next_arrival = 0, saved_terminated = 0;
+  int32_t saved_running = 0, saved_last_out = 0;
+  double saved_wait_time = 0, saved_n_wait = 0, saved_turnaround_time = 0;
+  int saved_cs = 0, saved_preemption = 0;
+  std::vector<process::progress> progress;
+  std::vector<sim_time> saved_stopped, saved_enqueued, wakes;
+  std::vector<process_latency> saved_latency;
+  std::vector<int32_t> queue, pre_ready, sleeping;
+  latency_histogram histograms[3];
+  std::vector<char> policy;
+  r.get(saved_started);
+  r.get(saved_state);
+  r.get(saved_time);
+  r.get(saved_wait_clock);
+  r.get(saved_dispatched);
+  r.get(saved_io_clock);
+  r.get(saved_switch_time);
+  r.get(saved_next_arrival);
+  r.get(saved_terminated);
+  r.get(saved_running);
+  r.get(saved_last_out);
+  r.get(saved_wait_time);
+  r.get(saved_n_wait);
+  r.get(saved_turnaround_time);
+  r.get(saved_cs);
+  r.get(saved_preemption);
+  r.get_vector(progress);
+  r.get_vector(saved_stopped);
+  r.get_vector(saved_enqueued);
+  r.get_vector(saved_latency);
+  r.get_vector(queue);
+  r.get_vector(pre_ready);
+  r.get_vector(wakes);
+  r.get_vector(sleeping);
+  for (auto &h : histograms) {
+    if (!h.restore(r)) {
+      return false;
+    }
+  }
+  r.get_vector(policy);
+  const size_t n = processes.size();
+  if (!r.good() || !r.at_end() || saved_next_arrival > n ||
+      saved_terminated > n || saved_running < -1 || saved_running >= (int)n ||
+      saved_last_out < -1 || saved_last_out >= (int)n ||
+      progress.size() != n || saved_stopped.size() != n ||
+      saved_enqueued.size() != n || saved_latency.size() != n ||
+      wakes.size() != sleeping.size() || !valid_indices(queue, n, false) ||
+      !valid_indices(pre_ready, n, true) ||
+      !valid_indices(sleeping, n, false)) {
+    return false;
+  }
+  snapshot_reader policy_reader(policy);
+  if (!restore_policy(policy_reader)) {
+    return false;
+  }
+  started = saved_started;
+  cpu_state = saved_state;
+  time = saved_time;
+  wait_clock = saved_wait_clock;
+  dispatched = saved_dispatched;
+  io_clock = saved_io_clock;
+  switch_time = saved_switch_time;
+  next_arrival = saved_next_arrival;
+  n_terminated = saved_terminated;
+  running = saved_running == -1 ? processes.end()
+                                : processes.begin() + saved_running;
+  last_out = saved_last_out == -1 ? processes.end()
+                                  : processes.begin() + saved_last_out;
+  wait_time = saved_wait_time;
+  n_wait = saved_n_wait;
+  turnaround_time = saved_turnaround_time;
+  n_cs = saved_cs;
+  n_preemption = saved_preemption;
+  for (size_t i = 0; i < n; ++i) {
+    processes[i].set_progress(progress[i]);
+  }
+  stopped.swap(saved_stopped);
+  enqueued.swap(saved_enqueued);
+  latency.swap(saved_latency);
+  // Queued front first, so any queue ends up in the same order
+  while (!ready_queue->empty()) {
+    ready_queue->pop_front();
+  }
+  while (shortest != NULL && !shortest->empty()) {
+    shortest->pop_front();
+  }
+  for (auto i : queue) {
+    ready_queue->push_back(processes.begin() + i);
+    if (shortest != NULL) {
+      shortest->push_back(processes.begin() + i);
+    }
+  }
+  pre_ready_queue.clear();
+  for (auto i : pre_ready) {
+    pre_ready_queue.push_back(i == -1 ? processes.end()
+                                      : processes.begin() + i);
+  }
+  blocked.clear();
+  for (size_t i = 0; i < sleeping.size(); ++i) {
+    blocked.add(processes.begin() + sleeping[i], wakes[i]);
+  }
+  wait_histogram = histograms[0];
+  turnaround_histogram = histograms[1];
+  response_histogram = histograms[2];
+  return true;
+}
+
+schedule_algorithm *
+schedule_algorithm::fork(const schedule_parameters &parameters) const {
+  std::vector<char> checkpoint;
+  if (!save(checkpoint)) {
+    return NULL;
+  }
+  schedule_algorithm *copy = make_scheduler(name, jobs, parameters);
+  if (copy == NULL || !copy->restore(checkpoint)) {
+    delete copy;
+    return NULL;
+  }
+  return copy;
+}
+
+FCFS_scheduling::FCFS_scheduling(std::shared_ptr<const workload> p, const int t_cs)
+    : schedule_algorithm(p, t_cs, "FCFS") {}
 
 void FCFS_scheduling::run() {
-  print_overview();
-  print_event("Simulator started for FCFS");
-  int state = -2;
+  if (!started) {
+    started = true;
+    print_overview();
+    TRACE_EVENT(TRACE_START);
+  }
+  int state = cpu_state;
   int cs = 0;
-  while (terminated.size() < processes.size()) {
+  while (!all_terminated() && time < pause_at) {
+    // Jump over the ms in which nothing can happen
+    if (state == 1 || (state == -2 && ready_queue->empty())) {
+      const sim_time ticks =
+          quiet_ticks(std::numeric_limits<sim_time>::max());
+      if (ticks > 0) {
+        state = fast_forward(ticks);
+        continue;
+      }
+    }
     if (state == 0) {
-      std::stringstream event;
-      std::string plural =
-          running->get_remaining_CPU_bursts() > 1 ? " bursts " : " burst ";
-      event << "Process " << running->get_ID() << " completed a CPU burst; "
-            << running->get_remaining_CPU_bursts() << plural << "to go";
-      print_event(event.str());
+      TRACE_EVENT(TRACE_BURST_DONE, running->get_ID(),
+                  running->get_remaining_CPU_bursts());
     } else if (state == -1) {
-      std::stringstream event;
-      event << "Process " << running->get_ID() << " terminated";
-      print_event(event.str());
+      TRACE_EVENT(TRACE_TERMINATED, running->get_ID());
     }
     // check if any new processes have the same arrival time.
     check_arrival();
@@ -251,8 +884,8 @@ void FCFS_scheduling::run() {
 
     // Determine context switch
     if (state != 1) {
-      if (!ready_queue.empty()) {
-        context_switch(*(ready_queue.begin()));
+      if (!ready_queue->empty()) {
+        context_switch(ready_queue->front());
         cs = 1;
         state = 1;
       } else if (state != -2) {
@@ -270,7 +903,6 @@ void FCFS_scheduling::run() {
     // then skip to next 1 ms.
     if (running != processes.end()) {
       state = running->run_for_1ms();
-      turnaround_time += 1;
     } else {
       // no current running process
       state = -2;
@@ -278,49 +910,59 @@ void FCFS_scheduling::run() {
     // time increment
     ++time;
   }
-  print_event("Simulator ended for FCFS");
+  cpu_state = state;
+  if (all_terminated()) {
+    TRACE_EVENT(TRACE_END);
+    dump_trace();
+    finish_timeline();
+  }
 }
 
 void FCFS_scheduling::perform_add_to_ready_queue() {
   std::sort(pre_ready_queue.begin(), pre_ready_queue.end(), resolveTie);
   for (auto i : pre_ready_queue) {
-    ready_queue.push_back(i);
-    std::stringstream event;
+    enqueue(i);
     if (i->get_arrival_time() == time) {
-      event << "Process " << i->get_ID() << " arrived; added to ready queue";
+      TRACE_EVENT(TRACE_ARRIVAL, i->get_ID());
     } else {
-      event << "Process " << i->get_ID()
-            << " completed I/O; added to ready queue";
+      TRACE_EVENT(TRACE_IO_DONE, i->get_ID());
     }
-    print_event(event.str());
     n_wait += 1;
   }
   pre_ready_queue.clear();
 }
 
-RR_scheduling::RR_scheduling(const std::vector<process> &p, const int t_cs,
+RR_scheduling::RR_scheduling(std::shared_ptr<const workload> p, const int t_cs,
                              const int t_slice, const bool add)
-    : schedule_algorithm(p, t_cs), t_slice(t_slice), add(add) {}
+    : schedule_algorithm(p, t_cs, "RR"), t_slice(t_slice), add(add),
+      time_running(0) {}
 
 void RR_scheduling::run() {
-  print_overview();
-  print_event("Simulator started for RR");
-  // The time the current process is running for
-  int time_running = 0;
-  int state = -2;
+  if (!started) {
+    started = true;
+    print_overview();
+    TRACE_EVENT(TRACE_START);
+  }
+  int state = cpu_state;
   int cs = 0;
-  while (terminated.size() < processes.size()) {
+  while (!all_terminated() && time < pause_at) {
+    // Jump over the ms in which nothing can happen
+    if ((state == 1 || (state == -2 && ready_queue->empty())) &&
+        time_running < t_slice) {
+      const sim_time ticks = quiet_ticks(t_slice - time_running);
+      if (ticks > 0) {
+        state = fast_forward(ticks);
+        if (running != processes.end()) {
+          time_running += ticks;
+        }
+        continue;
+      }
+    }
     if (state == 0) {
-      std::stringstream event;
-      std::string plural =
-          running->get_remaining_CPU_bursts() > 1 ? " bursts " : " burst ";
-      event << "Process " << running->get_ID() << " completed a CPU burst; "
-            << running->get_remaining_CPU_bursts() << plural << "to go";
-      print_event(event.str());
+      TRACE_EVENT(TRACE_BURST_DONE, running->get_ID(),
+                  running->get_remaining_CPU_bursts());
     } else if (state == -1) {
-      std::stringstream event;
-      event << "Process " << running->get_ID() << " terminated";
-      print_event(event.str());
+      TRACE_EVENT(TRACE_TERMINATED, running->get_ID());
     }
     // check if any new processes have the same arrival time.
     check_arrival();
@@ -332,8 +974,8 @@ void RR_scheduling::run() {
     // all processes in ready queue wait for 1ms
     do_waiting();
     if (state != 1) {
-      if (!ready_queue.empty()) {
-        context_switch(*(ready_queue.begin()));
+      if (!ready_queue->empty()) {
+        context_switch(ready_queue->front());
         cs = 1;
         state = 1;
         time_running = 0;
@@ -345,21 +987,16 @@ void RR_scheduling::run() {
       }
     }
     // when time slice expires
-    if (time_running >= t_slice && !ready_queue.empty()) {
-      std::stringstream event;
-      event << "Time slice expired; process " << running->get_ID()
-            << " preempted with " << running->get_remaining_time()
-            << "ms to go";
-      print_event(event.str());
-      context_switch(*(ready_queue.begin()));
+    if (time_running >= t_slice && !ready_queue->empty()) {
+      TRACE_EVENT(TRACE_SLICE_PREEMPT, running->get_ID(),
+                  running->get_remaining_time());
+      context_switch(ready_queue->front());
       time_running = 0;
       cs = 1;
       state = 1;
       ++n_preemption;
     } else if (time_running >= t_slice) {
-      std::stringstream event;
-      event << "Time slice expired; no preemption because ready queue is empty";
-      print_event(event.str());
+      TRACE_EVENT(TRACE_SLICE_NO_PREEMPT);
       time_running = 0;
     }
     if (cs == 1) {
@@ -371,7 +1008,6 @@ void RR_scheduling::run() {
     // then skip to next 1 ms.
     if (running != processes.end()) {
       state = running->run_for_1ms();
-      turnaround_time += 1;
       ++time_running;
     } else {
       // no current running process
@@ -379,61 +1015,85 @@ void RR_scheduling::run() {
     }
     time++;
   }
-  print_event("Simulator ended for RR");
+  cpu_state = state;
+  if (all_terminated()) {
+    TRACE_EVENT(TRACE_END);
+    dump_trace();
+    finish_timeline();
+  }
+}
+
+bool RR_scheduling::save_policy(snapshot_writer &w) const {
+  w.put(time_running);
+  return true;
+}
+
+bool RR_scheduling::restore_policy(snapshot_reader &r) {
+  int saved;
+  if (!r.get(saved) || !r.at_end()) {
+    return false;
+  }
+  time_running = saved;
+  return true;
 }
 
 void RR_scheduling::perform_add_to_ready_queue() {
   std::sort(pre_ready_queue.begin(), pre_ready_queue.end(), resolveTie);
   for (auto i : pre_ready_queue) {
     if (add == true) {
-      ready_queue.push_front(i);
+      enqueue(i, true);
     } else {
-      ready_queue.push_back(i);
+      enqueue(i);
     }
     if (i->preempted()) {
       continue;
     }
     n_wait += 1;
-    std::stringstream event;
     if (i->get_arrival_time() == time) {
-      event << "Process " << i->get_ID() << " arrived; added to ready queue";
+      TRACE_EVENT(TRACE_ARRIVAL, i->get_ID());
     } else {
-      event << "Process " << i->get_ID()
-            << " completed I/O; added to ready queue";
+      TRACE_EVENT(TRACE_IO_DONE, i->get_ID());
     }
-    print_event(event.str());
   }
   pre_ready_queue.clear();
 }
 
-SJF_scheduling::SJF_scheduling(const std::vector<process> &p, const int t_cs,
+SJF_scheduling::SJF_scheduling(std::shared_ptr<const workload> p, const int t_cs,
                                const double lambda, const double alpha)
-    : schedule_algorithm(p, t_cs), lambda(lambda), alpha(alpha) {}
+    : schedule_algorithm(p, t_cs, "SJF") {
+  predictor.reset(new ewma_predictor(1 / lambda, alpha));
+  shortest.reset(new indexed_heap_queue(processes, ShorterActualTime));
+  ready_queue.reset(new indexed_heap_queue(processes, ShorterJobTime));
+}
 
 void SJF_scheduling::run() {
-  print_overview();
-  print_event("Simulator started for SJF");
-  int state = -2;
+  if (!started) {
+    started = true;
+    print_overview();
+    TRACE_EVENT(TRACE_START);
+  }
+  int state = cpu_state;
   int cs = 0;
-  while (terminated.size() < processes.size()) {
+  while (!all_terminated() && time < pause_at) {
+    // Jump over the ms in which nothing can happen
+    if (state == 1 || (state == -2 && ready_queue->empty())) {
+      const sim_time ticks =
+          quiet_ticks(std::numeric_limits<sim_time>::max());
+      if (ticks > 0) {
+        state = fast_forward(ticks);
+        continue;
+      }
+    }
     if (state == 0) {
-      std::stringstream event1, event2;
-      std::string plural =
-          running->get_remaining_CPU_bursts() > 1 ? " bursts " : " burst ";
-      event1 << "Process " << running->get_ID() << " completed a CPU burst; "
-             << running->get_remaining_CPU_bursts() << plural << "to go";
-      print_event(event1.str());
+      TRACE_EVENT(TRACE_BURST_DONE, running->get_ID(),
+                  running->get_remaining_CPU_bursts());
       // Recalculate tau for the process that completes its burst
-      int tau = est_tau(running->get_last_estimated_burst_time(),
-                        running->get_last_burst_time());
-      running->set_estimated_remaining_time(tau);
-      event2 << "Recalculated tau = " << tau << "ms for process "
-             << running->get_ID();
-      print_event(event2.str());
+      next_estimate(running);
+      TRACE_EVENT(TRACE_TAU, running->get_ID(),
+                  running->get_last_estimated_burst_time());
     } else if (state == -1) {
-      std::stringstream event;
-      event << "Process " << running->get_ID() << " terminated";
-      print_event(event.str());
+      score_estimate(running);
+      TRACE_EVENT(TRACE_TERMINATED, running->get_ID());
     }
     // check if have any new processes have the same arrival time.
     check_arrival();
@@ -446,8 +1106,8 @@ void SJF_scheduling::run() {
     do_waiting();
     // Determine context switch
     if (state != 1) {
-      if (!ready_queue.empty()) {
-        context_switch(*(ready_queue.begin()));
+      if (!ready_queue->empty()) {
+        context_switch(ready_queue->front());
         cs = 1;
         state = 1;
       } else if (state != -2) {
@@ -465,7 +1125,6 @@ void SJF_scheduling::run() {
     // then skip to next 1 ms.
     if (running != processes.end()) {
       state = running->run_for_1ms();
-      turnaround_time += 1;
     } else {
       // no current running process
       state = -2;
@@ -473,64 +1132,67 @@ void SJF_scheduling::run() {
     // time increment
     ++time;
   }
-  print_event("Simulator ended for SJF");
+  cpu_state = state;
+  if (all_terminated()) {
+    TRACE_EVENT(TRACE_END);
+    dump_trace();
+    finish_timeline();
+  }
 }
 void SJF_scheduling::perform_add_to_ready_queue() {
   for (auto i : pre_ready_queue) {
-    ready_queue.push_back(i);
-    std::stringstream event;
     if (i->get_arrival_time() == time) {
-      // Set tau0 for new process
-      i->set_estimated_remaining_time(1 / lambda);
-      ready_queue.sort(ShorterJobTime);
-      event << "Process " << i->get_ID() << " (tau "
-            << i->get_last_estimated_burst_time() << "ms)"
-            << " arrived; added to ready queue";
+      // Set tau0 for new process before it is ordered by it
+      start_estimate(i);
+      enqueue(i);
+      TRACE_EVENT(TRACE_ARRIVAL_TAU, i->get_ID(),
+                  i->get_last_estimated_burst_time());
     } else {
-      ready_queue.sort(ShorterJobTime);
-      event << "Process " << i->get_ID() << " (tau "
-            << i->get_last_estimated_burst_time() << "ms)"
-            << " completed I/O; added to ready queue";
+      enqueue(i);
+      TRACE_EVENT(TRACE_IO_DONE_TAU, i->get_ID(),
+                  i->get_last_estimated_burst_time());
     }
-    print_event(event.str());
     n_wait += 1;
   }
   pre_ready_queue.clear();
 }
 
-int SJF_scheduling::est_tau(double tau, int t) {
-  int next_est = (int)ceil(alpha * t + (1 - alpha) * tau);
-  return next_est;
-}
-
-SRT_scheduling::SRT_scheduling(const std::vector<process> &p, const int t_cs,
+SRT_scheduling::SRT_scheduling(std::shared_ptr<const workload> p, const int t_cs,
                                const double lambda, const double alpha)
-    : schedule_algorithm(p, t_cs), lambda(lambda), alpha(alpha),
-      preempting_process(processes.end()) {}
+    : schedule_algorithm(p, t_cs, "SRT"),
+      preempting_process(processes.end()) {
+  predictor.reset(new ewma_predictor(1 / lambda, alpha));
+  shortest.reset(new indexed_heap_queue(processes, ShorterActualTime));
+  ready_queue.reset(new indexed_heap_queue(processes, ShorterRemainingTime));
+}
 
 void SRT_scheduling::run() {
-  print_overview();
-  print_event("Simulator started for SRT");
-  int state = -2;
+  if (!started) {
+    started = true;
+    print_overview();
+    TRACE_EVENT(TRACE_START);
+  }
+  int state = cpu_state;
   int cs = 0;
-  while (terminated.size() < processes.size()) {
+  while (!all_terminated() && time < pause_at) {
+    // Jump over the ms in which nothing can happen
+    if (state == 1 || (state == -2 && ready_queue->empty())) {
+      const sim_time ticks =
+          quiet_ticks(std::numeric_limits<sim_time>::max());
+      if (ticks > 0) {
+        state = fast_forward(ticks);
+        continue;
+      }
+    }
     if (state == 0) {
-      std::stringstream event1, event2;
-      std::string plural =
-          running->get_remaining_CPU_bursts() > 1 ? " bursts " : " burst ";
-      event1 << "Process " << running->get_ID() << " completed a CPU burst; "
-             << running->get_remaining_CPU_bursts() << plural << "to go";
-      print_event(event1.str());
-      int tau = est_tau(running->get_last_estimated_burst_time(),
-                        running->get_last_burst_time());
-      running->set_estimated_remaining_time(tau);
-      event2 << "Recalculated tau = " << tau << "ms for process "
-             << running->get_ID();
-      print_event(event2.str());
+      TRACE_EVENT(TRACE_BURST_DONE, running->get_ID(),
+                  running->get_remaining_CPU_bursts());
+      next_estimate(running);
+      TRACE_EVENT(TRACE_TAU, running->get_ID(),
+                  running->get_last_estimated_burst_time());
     } else if (state == -1) {
-      std::stringstream event;
-      event << "Process " << running->get_ID() << " terminated";
-      print_event(event.str());
+      score_estimate(running);
+      TRACE_EVENT(TRACE_TERMINATED, running->get_ID());
     }
     // check if any new processes have the same arrival time.
     check_arrival();
@@ -546,10 +1208,10 @@ void SRT_scheduling::run() {
     // all processes in ready queue wait for 1ms
     do_waiting();
     if (state != 1) {
-      if (!ready_queue.empty()) {
-        context_switch(*(ready_queue.begin()));
-        while (!ready_queue.empty() &&
-               ShorterRemainingTime(*(ready_queue.begin()), running)) {
+      if (!ready_queue->empty()) {
+        context_switch(ready_queue->front());
+        while (!ready_queue->empty() &&
+               ShorterRemainingTime(ready_queue->front(), running)) {
           ready_queue_preemption();
           ++n_preemption;
         }
@@ -565,8 +1227,8 @@ void SRT_scheduling::run() {
     if (preempting_process != processes.end()) {
       ++n_preemption;
       context_switch(preempting_process);
-      while (!ready_queue.empty() &&
-             ShorterRemainingTime(*(ready_queue.begin()), running)) {
+      while (!ready_queue->empty() &&
+             ShorterRemainingTime(ready_queue->front(), running)) {
         ready_queue_preemption();
         ++n_preemption;
       }
@@ -582,14 +1244,18 @@ void SRT_scheduling::run() {
     // then skip to next 1 ms.
     if (running != processes.end()) {
       state = running->run_for_1ms();
-      turnaround_time += 1;
     } else {
       // no current running process
       state = -2;
     }
     time++;
   }
-  print_event("Simulator ended for SRT");
+  cpu_state = state;
+  if (all_terminated()) {
+    TRACE_EVENT(TRACE_END);
+    dump_trace();
+    finish_timeline();
+  }
 }
 
 void SRT_scheduling::perform_add_to_ready_queue() {
@@ -600,33 +1266,32 @@ void SRT_scheduling::perform_add_to_ready_queue() {
     if (i != preempting_process) {
       n_wait += 1;
     }
-    ready_queue.push_back(i);
-    std::stringstream event;
     if (i->preempted() || i == running || i == preempting_process) {
-      ready_queue.sort(ShorterRemainingTime);
+      enqueue(i);
       continue;
     }
     if (i->get_arrival_time() == time) {
-      // Set tau0 for new process
-      i->set_estimated_remaining_time(1 / lambda);
-      ready_queue.sort(ShorterRemainingTime);
-      event << "Process " << i->get_ID() << " (tau "
-            << i->get_last_estimated_burst_time() << "ms)"
-            << " arrived; added to ready queue";
+      // Set tau0 for new process before it is ordered by it
+      start_estimate(i);
+      enqueue(i);
+      TRACE_EVENT(TRACE_ARRIVAL_TAU, i->get_ID(),
+                  i->get_last_estimated_burst_time());
     } else {
-      ready_queue.sort(ShorterRemainingTime);
-      event << "Process " << i->get_ID() << " (tau "
-            << i->get_last_estimated_burst_time() << "ms)"
-            << " completed I/O; added to ready queue";
+      enqueue(i);
+      TRACE_EVENT(TRACE_IO_DONE_TAU, i->get_ID(),
+                  i->get_last_estimated_burst_time());
     }
-    print_event(event.str());
   }
   pre_ready_queue.clear();
 }
 
-int SRT_scheduling::est_tau(double tau, int t) {
-  int next_est = (int)ceil(alpha * t + (1 - alpha) * tau);
-  return next_est;
+bool SRT_scheduling::restore_policy(snapshot_reader &r) {
+  if (!predictor->restore(r)) {
+    return false;
+  }
+  // Only set and used within a ms
+  preempting_process = processes.end();
+  return true;
 }
 
 process_ptr SRT_scheduling::check_preemption() {
@@ -638,7 +1303,7 @@ process_ptr SRT_scheduling::check_preemption() {
   for (auto i : pre_ready_queue) {
     if (i->get_arrival_time() == time) {
       // Set tau0 for new process
-      i->set_estimated_remaining_time(1 / lambda);
+      start_estimate(i);
     }
     // Compare remainiing time and current remaining time
     if (i->get_estimated_remaining_time() < remaining_time) {
@@ -653,25 +1318,22 @@ process_ptr SRT_scheduling::check_preemption() {
         i = processes.end();
       }
     }
-    ready_queue.push_back(return_value);
-    ready_queue.sort(ShorterRemainingTime);
-    std::stringstream event;
+    enqueue(return_value);
     if (time == return_value->get_arrival_time()) {
-      event << "Process " << return_value->get_ID() << " (tau "
-            << return_value->get_estimated_remaining_time()
-            << "ms) will preempt " << running->get_ID();
+      TRACE_EVENT(TRACE_PREEMPT, return_value->get_ID(),
+                  return_value->get_estimated_remaining_time(),
+                  running->get_ID());
     } else {
-      event << "Process " << return_value->get_ID() << " (tau "
-            << return_value->get_estimated_remaining_time()
-            << "ms) completed I/O and will preempt " << running->get_ID();
+      TRACE_EVENT(TRACE_IO_PREEMPT, return_value->get_ID(),
+                  return_value->get_estimated_remaining_time(),
+                  running->get_ID());
     }
-    print_event(event.str());
   }
   return return_value;
 }
 
 void SRT_scheduling::ready_queue_preemption() {
-  process_ptr preempting_process = ready_queue.front();
+  process_ptr preempting_process = ready_queue->front();
   int remaining_time = preempting_process->get_estimated_remaining_time();
   // check if have any new processes have the same arrival time.
   check_arrival();
@@ -681,7 +1343,7 @@ void SRT_scheduling::ready_queue_preemption() {
   for (auto i : pre_ready_queue) {
     if (i->get_arrival_time() == time) {
       // Set tau0 for new process
-      i->set_estimated_remaining_time(1 / lambda);
+      start_estimate(i);
     }
     // Compare remainiing time and current remaining time
     if (i->get_estimated_remaining_time() < remaining_time) {
@@ -690,30 +1352,23 @@ void SRT_scheduling::ready_queue_preemption() {
     }
   }
 
-  std::stringstream event;
+  bool from_io = false;
   for (auto &i : pre_ready_queue) {
     if (i == preempting_process) {
       i = processes.end();
-      ready_queue.push_back(preempting_process);
-      ready_queue.sort(ShorterRemainingTime);
-    }
-    if (time == preempting_process->get_arrival_time()) {
-      event << "Process " << preempting_process->get_ID() << " (tau "
-            << preempting_process->get_estimated_remaining_time()
-            << "ms) will preempt " << running->get_ID();
-    } else {
-      event << "Process " << preempting_process->get_ID() << " (tau "
-            << preempting_process->get_estimated_remaining_time()
-            << "ms) completed I/O and will preempt " << running->get_ID();
+      enqueue(preempting_process);
+      from_io = time != preempting_process->get_arrival_time();
     }
   }
-
-  if (preempting_process == *(ready_queue.begin())) {
-    event << "Process " << preempting_process->get_ID() << " (tau "
-          << preempting_process->get_estimated_remaining_time()
-          << "ms) will preempt " << running->get_ID();
+  if (from_io) {
+    TRACE_EVENT(TRACE_IO_PREEMPT, preempting_process->get_ID(),
+                preempting_process->get_estimated_remaining_time(),
+                running->get_ID());
+  } else {
+    TRACE_EVENT(TRACE_PREEMPT, preempting_process->get_ID(),
+                preempting_process->get_estimated_remaining_time(),
+                running->get_ID());
   }
-  print_event(event.str());
 
   perform_add_to_ready_queue();
 
@@ -721,3 +1376,652 @@ void SRT_scheduling::ready_queue_preemption() {
 
   context_switch(preempting_process);
 }
+
+MLFQ_scheduling::MLFQ_scheduling(std::shared_ptr<const workload> p,
+                                 const int t_cs,
+                                 const std::vector<int> &quanta,
+                                 const int boost)
+    : schedule_algorithm(p, t_cs, "MLFQ"), quanta(quanta), boost(boost),
+      next_boost(boost), used(processes.size(), 0) {
+  levels = new multilevel_queue(processes, quanta.size());
+  ready_queue.reset(levels);
+}
+
+void MLFQ_scheduling::run() {
+  print_overview();
+  TRACE_EVENT(TRACE_START);
+  int state = -2;
+  int cs = 0;
+  while (!all_terminated()) {
+    // Jump over the ms in which nothing can happen, up to the end of the
+    // quantum and the next boost
+    if (state == 1 || (state == -2 && ready_queue->empty())) {
+      sim_time limit = std::numeric_limits<sim_time>::max();
+      if (boost > 0) {
+        limit = next_boost - time;
+      }
+      if (running != processes.end()) {
+        limit = std::min(limit, quantum_left());
+      }
+      const sim_time ticks = limit > 0 ? quiet_ticks(limit) : 0;
+      if (ticks > 0) {
+        state = fast_forward(ticks);
+        if (running != processes.end()) {
+          used[running - processes.begin()] += ticks;
+        }
+        continue;
+      }
+    }
+    if (state == 0) {
+      TRACE_EVENT(TRACE_BURST_DONE, running->get_ID(),
+                  running->get_remaining_CPU_bursts());
+    } else if (state == -1) {
+      TRACE_EVENT(TRACE_TERMINATED, running->get_ID());
+    }
+    // check if any new processes have the same arrival time.
+    check_arrival();
+    // block processes on I/O for 1ms
+    do_blocking();
+    // loop for all the processes in the pre_ready_queue to push_back them
+    // into ready queue
+    perform_add_to_ready_queue();
+    // all processes in ready queue wait for 1ms
+    do_waiting();
+    if (boost > 0 && time >= next_boost) {
+      priority_boost();
+    }
+    if (state != 1) {
+      if (!ready_queue->empty()) {
+        context_switch(ready_queue->front());
+        cs = 1;
+        state = 1;
+      } else if (state != -2) {
+        context_switch(processes.end());
+        cs = 1;
+        state = -2;
+      }
+    } else if (!ready_queue->empty() &&
+               levels->get_level(ready_queue->front()) <
+                   levels->get_level(running)) {
+      // A process on a higher level became ready
+      TRACE_EVENT(TRACE_LEVEL_PREEMPT, ready_queue->front()->get_ID(),
+                  levels->get_level(ready_queue->front()), running->get_ID());
+      context_switch(ready_queue->front());
+      cs = 1;
+      ++n_preemption;
+    } else if (quantum_left() == 0) {
+      // Quantum used up: down a level, or again on the last one
+      const int level = levels->get_level(running);
+      if (level + 1 < levels->get_levels()) {
+        levels->set_level(running, level + 1);
+      }
+      used[running - processes.begin()] = 0;
+      if (!ready_queue->empty()) {
+        TRACE_EVENT(TRACE_SLICE_PREEMPT, running->get_ID(),
+                    running->get_remaining_time());
+        context_switch(ready_queue->front());
+        cs = 1;
+        ++n_preemption;
+      } else {
+        TRACE_EVENT(TRACE_SLICE_NO_PREEMPT);
+      }
+    }
+    if (cs == 1) {
+      // time does not increment after context switch
+      cs = 0;
+      continue;
+    }
+    // Run the running process for 1 ms. If there is no running process
+    // then skip to next 1 ms.
+    if (running != processes.end()) {
+      state = running->run_for_1ms();
+      ++used[running - processes.begin()];
+    } else {
+      // no current running process
+      state = -2;
+    }
+    time++;
+  }
+  TRACE_EVENT(TRACE_END);
+  dump_trace();
+  finish_timeline();
+}
+
+void MLFQ_scheduling::perform_add_to_ready_queue() {
+  std::sort(pre_ready_queue.begin(), pre_ready_queue.end(), resolveTie);
+  for (auto i : pre_ready_queue) {
+    enqueue(i);
+    if (i->preempted()) {
+      continue;
+    }
+    n_wait += 1;
+    if (i->get_arrival_time() == time) {
+      TRACE_EVENT(TRACE_ARRIVAL, i->get_ID());
+    } else {
+      TRACE_EVENT(TRACE_IO_DONE, i->get_ID());
+    }
+  }
+  pre_ready_queue.clear();
+}
+
+const sim_time MLFQ_scheduling::quantum_left() const {
+  const int quantum = quanta[levels->get_level(running)];
+  return std::max(0, quantum - used[running - processes.begin()]);
+}
+
+void MLFQ_scheduling::priority_boost() {
+  levels->boost();
+  std::fill(used.begin(), used.end(), 0);
+  // Boosts missed while switching happen late, not twice
+  next_boost += (time - next_boost) / boost * boost + boost;
+}
+
+// Weight of nice -20 to 19, from the Linux scheduler
+static const int nice_weights[40] = {
+    88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+    9548,  7620,  6100,  4904,  3906,  3121,  2501,  1991,  1586,  1277,
+    1024,  820,   655,   526,   423,   335,   272,   215,   172,   137,
+    110,   87,    70,    56,    45,    36,    29,    23,    18,    15};
+
+CFS_scheduling::CFS_scheduling(std::shared_ptr<const workload> p,
+                               const int t_cs, const int latency,
+                               const int granularity,
+                               const std::vector<int> &nice)
+    : schedule_algorithm(p, t_cs, "CFS"), latency(latency),
+      granularity(granularity), weight(processes.size(), 1024),
+      vruntime(processes.size(), 0), vruntime_rest(processes.size(), 0),
+      min_vruntime(0), queued_weight(0), slice_length(0), time_running(0),
+      wakeup_preempt(false) {
+  for (size_t i = 0; i < weight.size() && !nice.empty(); ++i) {
+    const int n = nice[i % nice.size()];
+    assert(n >= -20 && n < 20);
+    weight[i] = nice_weights[n + 20];
+  }
+  ready_queue.reset(new keyed_queue(processes, vruntime));
+}
+
+void CFS_scheduling::run() {
+  print_overview();
+  TRACE_EVENT(TRACE_START);
+  int state = -2;
+  int cs = 0;
+  while (!all_terminated()) {
+    // Jump over the ms in which nothing can happen, up to the end of the
+    // slice
+    if (state == 1 || (state == -2 && ready_queue->empty())) {
+      sim_time limit = std::numeric_limits<sim_time>::max();
+      if (running != processes.end()) {
+        limit = slice_length - time_running;
+      }
+      const sim_time ticks = limit > 0 ? quiet_ticks(limit) : 0;
+      if (ticks > 0) {
+        state = fast_forward(ticks);
+        if (running != processes.end()) {
+          charge(ticks);
+          time_running += ticks;
+        }
+        continue;
+      }
+    }
+    if (state == 0) {
+      TRACE_EVENT(TRACE_BURST_DONE, running->get_ID(),
+                  running->get_remaining_CPU_bursts());
+    } else if (state == -1) {
+      TRACE_EVENT(TRACE_TERMINATED, running->get_ID());
+    }
+    // check if any new processes have the same arrival time.
+    check_arrival();
+    // block processes on I/O for 1ms
+    do_blocking();
+    // loop for all the processes in the pre_ready_queue to push_back them
+    // into ready queue
+    perform_add_to_ready_queue();
+    // all processes in ready queue wait for 1ms
+    do_waiting();
+    if (state != 1) {
+      if (!ready_queue->empty()) {
+        switch_to(ready_queue->front());
+        cs = 1;
+        state = 1;
+      } else if (state != -2) {
+        switch_to(processes.end());
+        cs = 1;
+        state = -2;
+      }
+    } else if (wakeup_preempt && !ready_queue->empty()) {
+      switch_to(ready_queue->front());
+      cs = 1;
+      ++n_preemption;
+    } else if (time_running >= slice_length) {
+      // Preempt only for a process that has run less
+      if (!ready_queue->empty() &&
+          vruntime[ready_queue->front() - processes.begin()] <
+              vruntime[running - processes.begin()]) {
+        TRACE_EVENT(TRACE_SLICE_PREEMPT, running->get_ID(),
+                    running->get_remaining_time());
+        switch_to(ready_queue->front());
+        cs = 1;
+        ++n_preemption;
+      } else {
+        if (ready_queue->empty()) {
+          TRACE_EVENT(TRACE_SLICE_NO_PREEMPT);
+        } else {
+          TRACE_EVENT(TRACE_SLICE_KEEP, running->get_ID());
+        }
+        slice_length = slice();
+        time_running = 0;
+      }
+    }
+    if (cs == 1) {
+      // time does not increment after context switch
+      cs = 0;
+      continue;
+    }
+    // Run the running process for 1 ms. If there is no running process
+    // then skip to next 1 ms.
+    if (running != processes.end()) {
+      state = running->run_for_1ms();
+      charge(1);
+      ++time_running;
+    } else {
+      // no current running process
+      state = -2;
+    }
+    time++;
+  }
+  TRACE_EVENT(TRACE_END);
+  dump_trace();
+  finish_timeline();
+}
+
+void CFS_scheduling::perform_add_to_ready_queue() {
+  std::sort(pre_ready_queue.begin(), pre_ready_queue.end(), resolveTie);
+  for (auto i : pre_ready_queue) {
+    int64_t &v = vruntime[i - processes.begin()];
+    if (!i->preempted()) {
+      if (i->get_arrival_time() == time) {
+        v = min_vruntime;
+        vruntime_rest[i - processes.begin()] = 0;
+      } else {
+        // Sleeper credit
+        v = std::max(v, min_vruntime - latency * 1000 / 2);
+      }
+    }
+    enqueue(i);
+    queued_weight += weight[i - processes.begin()];
+    if (i->preempted()) {
+      continue;
+    }
+    n_wait += 1;
+    if (i->get_arrival_time() == time) {
+      TRACE_EVENT(TRACE_ARRIVAL, i->get_ID());
+    } else {
+      TRACE_EVENT(TRACE_IO_DONE, i->get_ID());
+    }
+    if (running != processes.end() && running->get_state() == 1 &&
+        v + granularity * 1000 < vruntime[running - processes.begin()]) {
+      TRACE_EVENT(TRACE_VRUNTIME_PREEMPT, i->get_ID(), v / 1000,
+                  running->get_ID());
+      wakeup_preempt = true;
+    }
+  }
+  pre_ready_queue.clear();
+}
+
+void CFS_scheduling::switch_to(process_ptr process_in) {
+  context_switch(process_in);
+  wakeup_preempt = false;
+  if (running != processes.end()) {
+    queued_weight -= weight[running - processes.begin()];
+    slice_length = slice();
+    time_running = 0;
+  }
+}
+
+void CFS_scheduling::charge(const sim_time ms) {
+  const size_t i = running - processes.begin();
+  // What does not make a whole us is kept for the next charge
+  const int64_t charged = vruntime_rest[i] + ms * 1024000;
+  vruntime[i] += charged / weight[i];
+  vruntime_rest[i] = charged % weight[i];
+  update_min_vruntime();
+}
+
+void CFS_scheduling::update_min_vruntime() {
+  int64_t least = vruntime[running - processes.begin()];
+  if (!ready_queue->empty()) {
+    least = std::min(least, vruntime[ready_queue->front() - processes.begin()]);
+  }
+  min_vruntime = std::max(min_vruntime, least);
+}
+
+const sim_time CFS_scheduling::slice() const {
+  const int64_t own = weight[running - processes.begin()];
+  const sim_time period =
+      std::max<sim_time>(latency, granularity * (ready_queue->size() + 1));
+  return std::max<sim_time>(1, period * own / (queued_weight + own));
+}
+
+share_scheduling::share_scheduling(std::shared_ptr<const workload> p,
+                                   const int t_cs, const std::string &name,
+                                   const int t_slice,
+                                   const std::vector<int> &tickets)
+    : schedule_algorithm(p, t_cs, name), tickets(processes.size(), 100),
+      t_slice(t_slice), time_running(0), ticket_clock(0), active_tickets(0),
+      joined_at(processes.size(), 0), entitled(processes.size(), 0),
+      received(processes.size(), 0) {
+  for (size_t i = 0; i < this->tickets.size() && !tickets.empty(); ++i) {
+    this->tickets[i] = tickets[i % tickets.size()];
+    assert(this->tickets[i] > 0);
+  }
+}
+
+void share_scheduling::run() {
+  print_overview();
+  TRACE_EVENT(TRACE_START);
+  int state = -2;
+  int cs = 0;
+  while (!all_terminated()) {
+    // Jump over the ms in which nothing can happen, up to the end of the
+    // slice
+    if (state == 1 || (state == -2 && ready_queue->empty())) {
+      sim_time limit = std::numeric_limits<sim_time>::max();
+      if (running != processes.end()) {
+        limit = t_slice - time_running;
+      }
+      const sim_time ticks = limit > 0 ? quiet_ticks(limit) : 0;
+      if (ticks > 0) {
+        state = fast_forward(ticks);
+        if (running != processes.end()) {
+          charge(ticks);
+          time_running += ticks;
+          if (state != 1) {
+            leave(running);
+          }
+        }
+        continue;
+      }
+    }
+    if (state == 0) {
+      TRACE_EVENT(TRACE_BURST_DONE, running->get_ID(),
+                  running->get_remaining_CPU_bursts());
+    } else if (state == -1) {
+      TRACE_EVENT(TRACE_TERMINATED, running->get_ID());
+    }
+    // check if any new processes have the same arrival time.
+    check_arrival();
+    // block processes on I/O for 1ms
+    do_blocking();
+    // loop for all the processes in the pre_ready_queue to push_back them
+    // into ready queue
+    perform_add_to_ready_queue();
+    // all processes in ready queue wait for 1ms
+    do_waiting();
+    if (state != 1) {
+      if (!ready_queue->empty()) {
+        context_switch(ready_queue->front());
+        cs = 1;
+        state = 1;
+        time_running = 0;
+      } else if (state != -2) {
+        context_switch(processes.end());
+        cs = 1;
+        state = -2;
+      }
+    } else if (time_running >= t_slice) {
+      if (ready_queue->empty()) {
+        TRACE_EVENT(TRACE_SLICE_NO_PREEMPT);
+      } else if (take_turn()) {
+        TRACE_EVENT(TRACE_SLICE_PREEMPT, running->get_ID(),
+                    running->get_remaining_time());
+        context_switch(ready_queue->front());
+        cs = 1;
+        ++n_preemption;
+      } else {
+        TRACE_EVENT(TRACE_SLICE_KEEP, running->get_ID());
+      }
+      time_running = 0;
+    }
+    if (cs == 1) {
+      // time does not increment after context switch
+      cs = 0;
+      continue;
+    }
+    // Run the running process for 1 ms. If there is no running process
+    // then skip to next 1 ms.
+    if (running != processes.end()) {
+      state = running->run_for_1ms();
+      charge(1);
+      ++time_running;
+      if (state != 1) {
+        leave(running);
+      }
+    } else {
+      // no current running process
+      state = -2;
+    }
+    time++;
+  }
+  TRACE_EVENT(TRACE_END);
+  dump_trace();
+  finish_timeline();
+}
+
+void share_scheduling::write_stats(std::ofstream &file) {
+  schedule_algorithm::write_stats(file);
+  double total_deviation = 0;
+  double max_deviation = 0;
+  int n_entitled = 0;
+  for (size_t i = 0; i < processes.size(); ++i) {
+    file << "-- process " << processes[i].get_name() << ": " << tickets[i]
+         << " tickets, entitled to " << entitled[i] << " ms of CPU, got "
+         << received[i] << " ms\n";
+    if (entitled[i] > 0) {
+      const double deviation =
+          100 * fabs(received[i] - entitled[i]) / entitled[i];
+      total_deviation += deviation;
+      max_deviation = std::max(max_deviation, deviation);
+      ++n_entitled;
+    }
+  }
+  file << "-- CPU share deviation from entitlement: average "
+       << (n_entitled > 0 ? total_deviation / n_entitled : 0) << "%, max "
+       << max_deviation << "%\n";
+}
+
+void share_scheduling::perform_add_to_ready_queue() {
+  std::sort(pre_ready_queue.begin(), pre_ready_queue.end(), resolveTie);
+  for (auto i : pre_ready_queue) {
+    if (i->preempted()) {
+      enqueue(i);
+      continue;
+    }
+    join(i);
+    joined(i);
+    enqueue(i);
+    n_wait += 1;
+    if (i->get_arrival_time() == time) {
+      TRACE_EVENT(TRACE_ARRIVAL, i->get_ID());
+    } else {
+      TRACE_EVENT(TRACE_IO_DONE, i->get_ID());
+    }
+  }
+  pre_ready_queue.clear();
+}
+
+void share_scheduling::charge(const sim_time ms) {
+  ticket_clock += (double)ms / active_tickets;
+  received[running - processes.begin()] += ms;
+  ran(ms);
+}
+
+void share_scheduling::join(process_ptr p) {
+  joined_at[p - processes.begin()] = ticket_clock;
+  active_tickets += tickets[p - processes.begin()];
+}
+
+void share_scheduling::leave(process_ptr p) {
+  const size_t i = p - processes.begin();
+  entitled[i] += tickets[i] * (ticket_clock - joined_at[i]);
+  active_tickets -= tickets[i];
+}
+
+// Stride of a process with one ticket
+static const int64_t stride1 = 1 << 20;
+
+stride_scheduling::stride_scheduling(std::shared_ptr<const workload> p,
+                                     const int t_cs, const int t_slice,
+                                     const std::vector<int> &tickets)
+    : share_scheduling(p, t_cs, "STRIDE", t_slice, tickets),
+      stride(processes.size()), pass(processes.size(), 0), global_pass(0) {
+  for (size_t i = 0; i < stride.size(); ++i) {
+    stride[i] = stride1 / this->tickets[i];
+  }
+  ready_queue.reset(new indexed_heap_queue(processes, pass));
+}
+
+void stride_scheduling::joined(process_ptr p) {
+  int64_t &own = pass[p - processes.begin()];
+  own = std::max(own, global_pass);
+}
+
+void stride_scheduling::ran(const sim_time ms) {
+  int64_t &own = pass[running - processes.begin()];
+  own += stride[running - processes.begin()] * ms;
+  int64_t least = own;
+  if (!ready_queue->empty()) {
+    least = std::min(least, pass[ready_queue->front() - processes.begin()]);
+  }
+  global_pass = std::max(global_pass, least);
+}
+
+bool stride_scheduling::take_turn() {
+  return pass[ready_queue->front() - processes.begin()] <
+         pass[running - processes.begin()];
+}
+
+lottery_scheduling::lottery_scheduling(std::shared_ptr<const workload> p,
+                                       const int t_cs, const int t_slice,
+                                       const std::vector<int> &tickets,
+                                       const int seed)
+    : share_scheduling(p, t_cs, "LOTTERY", t_slice, tickets) {
+  lottery = new lottery_queue(processes, this->tickets, seed);
+  ready_queue.reset(lottery);
+}
+
+bool lottery_scheduling::take_turn() {
+  return lottery->draw(tickets[running - processes.begin()]);
+}
+
+std::shared_ptr<const switch_cost>
+make_switch_cost(const schedule_parameters &parameters) {
+  if (parameters.switch_resume < 0 && parameters.switch_cache == 0) {
+    return NULL;
+  }
+  const int resume = parameters.switch_resume >= 0 ? parameters.switch_resume
+                                                   : parameters.t_cs / 2;
+  return std::make_shared<cache_switch_cost>(parameters.t_cs, resume,
+                                             parameters.switch_cache,
+                                             parameters.switch_cache_decay);
+}
+
+std::unique_ptr<burst_predictor>
+make_predictor(const schedule_parameters &parameters, const uint32_t n) {
+  const int tau0 =
+      parameters.tau0 > 0 ? parameters.tau0 : (int)(1 / parameters.lambda);
+  const std::string &name = parameters.predictor;
+  burst_predictor *p = NULL;
+  if (name.empty() || name == "ewma") {
+    p = new ewma_predictor(tau0, parameters.alpha);
+  } else if (name == "window") {
+    p = new window_predictor(n, tau0, parameters.predictor_window);
+  } else if (name == "median") {
+    p = new median_predictor(n, tau0, parameters.predictor_window);
+  } else if (name == "adaptive") {
+    p = new adaptive_predictor(n, tau0, parameters.alpha);
+  }
+  return std::unique_ptr<burst_predictor>(p);
+}
+
+// make_scheduler without the switch cost model
+static schedule_algorithm *
+new_scheduler(const std::string &name, std::shared_ptr<const workload> p,
+              const schedule_parameters &parameters) {
+  if (parameters.cores > 0) {
+    if (name != "SJF" && name != "SRT" && name != "FCFS" && name != "RR") {
+      return NULL;
+    }
+    return new multicore_scheduling(p, name, parameters);
+  } else if (name == "SJF") {
+    return new SJF_scheduling(p, parameters.t_cs, parameters.lambda,
+                              parameters.alpha);
+  } else if (name == "SRT") {
+    return new SRT_scheduling(p, parameters.t_cs, parameters.lambda,
+                              parameters.alpha);
+  } else if (name == "FCFS") {
+    return new FCFS_scheduling(p, parameters.t_cs);
+  } else if (name == "RR") {
+    return new RR_scheduling(p, parameters.t_cs, parameters.t_slice,
+                             parameters.rr_add);
+  } else if (name == "MLFQ") {
+    std::vector<int> quanta = parameters.mlfq_quanta;
+    if (quanta.empty()) {
+      quanta = {parameters.t_slice, 2 * parameters.t_slice,
+                4 * parameters.t_slice};
+    }
+    return new MLFQ_scheduling(p, parameters.t_cs, quanta,
+                               parameters.mlfq_boost);
+  } else if (name == "CFS") {
+    const int latency = parameters.cfs_latency > 0 ? parameters.cfs_latency
+                                                   : parameters.t_slice;
+    const int granularity = parameters.cfs_granularity > 0
+                                ? parameters.cfs_granularity
+                                : std::max(1, latency / 8);
+    return new CFS_scheduling(p, parameters.t_cs, latency, granularity,
+                              parameters.cfs_nice);
+  } else if (name == "STRIDE") {
+    return new stride_scheduling(p, parameters.t_cs, parameters.t_slice,
+                                 parameters.tickets);
+  } else if (name == "LOTTERY") {
+    return new lottery_scheduling(p, parameters.t_cs, parameters.t_slice,
+                                  parameters.tickets, parameters.lottery_seed);
+  }
+  return NULL;
+}
+
+schedule_algorithm *make_scheduler(const std::string &name,
+                                   std::shared_ptr<const workload> p,
+                                   const schedule_parameters &parameters) {
+  schedule_algorithm *s = new_scheduler(name, p, parameters);
+  std::shared_ptr<const switch_cost> costs = make_switch_cost(parameters);
+  if (s != NULL && costs != NULL) {
+    s->set_switch_cost(costs);
+  }
+  std::unique_ptr<burst_predictor> predictor =
+      make_predictor(parameters, p->size());
+  if (s != NULL && predictor != NULL) {
+    s->set_predictor(std::move(predictor));
+  }
+  return s;
+}
+
+schedule_algorithm *
+make_streamed_scheduler(const std::string &name,
+                        std::unique_ptr<process_stream> s,
+                        const uint32_t slots, std::ostream *retired,
+                        const schedule_parameters &parameters) {
+  if (parameters.cores > 0 ||
+      (name != "SJF" && name != "SRT" && name != "FCFS" && name != "RR")) {
+    return NULL;
+  }
+  // Placeholders for the slots, replaced by the processes of the stream
+  std::shared_ptr<workload> jobs = std::make_shared<workload>();
+  jobs->reserve(slots, slots);
+  const int burst = 1;
+  for (uint32_t i = 0; i < slots; ++i) {
+    jobs->add(0, &burst, 1);
+  }
+  schedule_algorithm *simulator = make_scheduler(name, jobs, parameters);
+  simulator->stream_from(std::move(s), retired);
+  return simulator;
+}
@@ -1,122 +1,646 @@
 #ifndef SCHEDULE
 #define SCHEDULE
 
+#include "histogram.h"
+#include "io_timer.h"
+#include "predictor.h"
 #include "process.h"
+#include "ready_queue.h"
+#include "snapshot.h"
+#include "stream.h"
+#include "switch_cost.h"
+#include "timeline.h"
+#include "trace.h"
+#include "workload.h"
 #include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <list>
+#include <limits>
 #include <math.h>
-#include <set>
-#include <sstream>
+#include <memory>
 #include <string>
 #include <vector>
 
-typedef std::vector<process>::iterator process_ptr;
+/* Percentiles of the latency of the bursts in ms, rounded up to the end
+of their histogram bucket (see histogram.h), and the maximum*/
+struct latency_percentiles {
+  int64_t p50;
+  int64_t p90;
+  int64_t p99;
+  int64_t p999;
+  int64_t max;
+};
+
+// The figures write_stats reports
+struct schedule_stats {
+  double average_burst_time;
+  double average_wait_time;
+  double average_turnaround_time;
+  int context_switches;
+  int preemptions;
+  // Multi-core runs only, 0 otherwise: moves between cores and the
+  // average share of the time the cores were running a process
+  int migrations;
+  double utilization;
+  // Ms spent switching processes in and out, all cores together
+  sim_time switch_time;
+  /* SJF and SRT only, 0 otherwise: the mean absolute error and the mean
+  error (positive when too long) of the burst estimates in ms, and the
+  share of the dispatches that the estimates got in the wrong order (see
+  predictor.h).*/
+  double prediction_error;
+  double prediction_bias;
+  double misordered;
+  latency_percentiles wait;
+  latency_percentiles turnaround;
+  latency_percentiles response;
+};
+
+// Where a multi-core run puts a process that becomes ready
+enum balance_policy {
+  // On the core it last ran on; idle cores steal from the longest queue
+  STEAL_BALANCE,
+  // On the core with the fewest processes, no stealing
+  SHORTEST_QUEUE_BALANCE,
+  // Always on core ID % cores
+  STATIC_BALANCE
+};
+
+// Settings of all the algorithms, most of them used by only some
+struct schedule_parameters {
+  int t_cs;
+  double lambda;
+  double alpha;
+  int t_slice;
+  bool rr_add;
+  // Number of cores, 0 for the single CPU simulators
+  int cores;
+  // Time added to the switch when a process moves to another core
+  int migration_cost;
+  balance_policy balance;
+  /* MLFQ: the time quantum of each level, the first level first, and
+  the period of the priority boost (0 for none). Without quanta MLFQ has
+  three levels of t_slice, 2 * t_slice and 4 * t_slice.*/
+  std::vector<int> mlfq_quanta;
+  int mlfq_boost;
+  /* CFS: target latency and minimum granularity in ms, t_slice and
+  latency / 8 when 0, and the nice values (-20 to 19) given to the
+  processes in turn by ID, 0 for all when empty.*/
+  int cfs_latency;
+  int cfs_granularity;
+  std::vector<int> cfs_nice;
+  /* Stride and lottery: the tickets given to the processes in turn by
+  ID, 100 for all when empty, and the seed of the lottery draws.*/
+  std::vector<int> tickets;
+  int lottery_seed;
+  /* Context switch costs (see switch_cost.h): the ms to switch in the
+  process that ran last again, t_cs / 2 when negative, and the warmth
+  penalty added to switching in any other process with its time
+  constant. Every half takes t_cs / 2 when switch_resume is negative and
+  switch_cache is 0.*/
+  int switch_resume;
+  int switch_cache;
+  int switch_cache_decay;
+  /* SJF and SRT: the burst predictor ("ewma", "window", "median" or
+  "adaptive", see predictor.h; ewma when empty), the number of bursts
+  the window and median predictors look at, and the estimate of the
+  first burst, 1 / lambda when 0.*/
+  std::string predictor;
+  int predictor_window;
+  int tau0;
+};
 
 class schedule_algorithm {
 public:
-  schedule_algorithm(const std::vector<process> &, const int);
+  schedule_algorithm(std::shared_ptr<const workload>, const int,
+                     const std::string &);
+  virtual ~schedule_algorithm() {}
   virtual void run() = 0;
-  void write_stats(std::ofstream &);
+  // Name of the algorithm, e.g. "FCFS"
+  const std::string &get_name() const { return name; };
+  // Simulated time in ms, the end of the simulation once run() returns
+  const sim_time get_time() const { return time; };
+  virtual void write_stats(std::ofstream &);
+  virtual const schedule_stats get_stats() const;
+  /* Send the overview and event log to o instead of std::cout. NULL
+  drops them.*/
+  void set_output(std::ostream *o) { out = o; };
+  /* Keep the events up to level (see trace.h) and write them after the
+  run. Needs a build with SCHED_TRACE.*/
+  void set_trace_level(const int level) { trace.set_level(level); };
+  // Cost the switches with c instead of t_cs / 2 per half
+  void set_switch_cost(std::shared_ptr<const switch_cost> c) {
+    switch_costs = c;
+  };
+  /* Estimate the bursts with p instead of exponential averaging. Only
+  SJF and SRT estimate bursts; the others ignore it.*/
+  void set_predictor(std::unique_ptr<burst_predictor> p) {
+    if (predictor != NULL) {
+      predictor = std::move(p);
+    }
+  };
+  /* Write the timeline of the run (see timeline.h) to o, NULL for none.
+  A restored or forked run shows only what happens from then on.*/
+  void set_timeline(std::ostream *o) {
+    timeline.reset(o != NULL ? new timeline_writer(*o, name) : NULL);
+  };
+  /* Take the processes from s instead of the workload, whose processes
+  then only serve as the slots the live processes are kept in (see
+  make_streamed_scheduler). The latency line of every process goes to
+  retired, if not NULL, as it terminates instead of by write_stats.*/
+  void stream_from(std::unique_ptr<process_stream> s, std::ostream *retired);
+  // Why a streamed run stopped early, NULL if it did not
+  const char *get_stream_error() const { return stream_error; };
+  /* Run until the simulated time reaches t, or to the end if that comes
+  first. run() and run_until() carry on from there. Only SJF, SRT, FCFS
+  and RR on a single CPU stop early, the others run to the end.*/
+  void run_until(const sim_time t);
+  /* Checkpoints: save writes all that is needed to carry on the run
+  from where it stopped to out (see snapshot.h), and restore reads it
+  back into a simulator of the same algorithm over the same workload,
+  whatever its parameters. Only SJF, SRT, FCFS and RR on a single CPU
+  and without a stream can be saved; save returns false for the others,
+  and restore returns false for a checkpoint that does not fit, leaving
+  the simulator as it was.*/
+  bool save(std::vector<char> &out) const;
+  bool restore(const std::vector<char> &in);
+  /* Build the simulator of this algorithm with parameters, like
+  make_scheduler, and carry on the run from where this one stopped, for
+  what-if runs from a common warm-up. NULL if this one cannot be saved.
+  The event trace of the copy starts where it was forked.*/
+  schedule_algorithm *fork(const schedule_parameters &parameters) const;
 
 protected:
   void print_overview();
-  /* Call context switch. Note this process pressumes that
-  this is the initial switch in for the incoming process and final
-  switch out for outcoming process
-  If this is not the initial switch in or final switch out,
-  call wait_for_1ms(false) for t_cs/2 milisecond outside
-  this function. */
+  /* The state of the policy in checkpoints. False when the policy cannot
+  be saved, as by default. restore_policy changes nothing when it returns
+  false.*/
+  virtual bool save_policy(snapshot_writer &) const { return false; };
+  virtual bool restore_policy(snapshot_reader &) { return false; };
+  // Whether every process has terminated, which ends the run
+  const bool all_terminated() const;
+  /* Call context switch. Switches the running process out and the
+  given one in (processes.end() for none), simulating the ms this takes
+  under the cost model and accounting the turnaround of both.*/
   void context_switch(process_ptr);
+  /* Simulate ticks ms of a context switch. Only the ms on which a
+  process arrives or completes its I/O are simulated one by one, the
+  ones in between are skipped in one step.*/
+  void switch_for(sim_time ticks);
+  /* Length of the halves of a switch under the cost model, counted in
+  the switch time. switch_out_cost notes that p stops running now, and
+  last is the process that ran last where p is switched in.*/
+  int switch_out_cost(process_ptr p);
+  int switch_in_cost(process_ptr p, process_ptr last);
   void check_arrival();
+  // Move next_arrival past the processes that arrived before now
+  void skip_past_arrivals();
+  // Streamed runs: put the processes arriving by now into free slots
+  void admit_arrivals();
+  // Streamed runs: free the slot of the terminated process p
+  void retire(process_ptr p);
+  // Write the latency line of the process in slot i
+  void write_latency(std::ostream &, const size_t i);
+  // Let the processes in the ready queue wait for 1ms
   void do_waiting();
+  // Add a process to the ready queue, at the head when front is true
+  void enqueue(process_ptr, const bool front = false);
+  // Remove the head of the ready queue and account for its wait
+  void dequeue();
+  // Add ms to the wait or turnaround time of the current burst of p
+  void add_wait(process_ptr, const sim_time ms);
+  void add_turnaround(process_ptr, const sim_time ms);
+  /* p starts running ms after its current burst became ready. Only the
+  first start of a burst counts.*/
+  void record_response(process_ptr, const sim_time ms);
+  // The current burst of p is done and switched out
+  void complete_burst(process_ptr);
+  // Burst estimates: p arrives and gets the estimate of its first burst
+  void start_estimate(process_ptr);
+  // p completed a CPU burst: score its estimate and estimate the next one
+  void next_estimate(process_ptr);
+  // p completed its last CPU burst: score its estimate
+  void score_estimate(process_ptr);
+  /* p was taken from its ready queue to run: score whether shortest
+  first would have run another process instead, one with a shorter burst
+  left that the estimates put behind p (see predictor.h). shortest holds
+  the queue by actual remaining time, p still included, and p is taken
+  out of it. Nothing is done when it is NULL.*/
+  void score_dispatch(process_ptr, indexed_heap_queue *shortest);
   void do_blocking();
   void prepare_add_to_ready_queue(process_ptr);
-  void print_event(const std::string);
+  /* Number of ms from now on in which no arrival, I/O completion, burst
+  completion or context switch can happen, capped by limit. Returns 0 when
+  the next ms has to be simulated on its own.*/
+  const sim_time quiet_ticks(const sim_time limit);
+  // The same, leaving out the end of the running burst
+  const sim_time quiet_queue_ticks(const sim_time limit);
+  /* Jump over ticks quiet ms in one step. Returns the state of the
+  running process afterwards, or -2 when the CPU is idle.*/
+  const int fast_forward(const sim_time ticks);
+  // Record an event with the current ready queue. Use TRACE_EVENT
+  void trace_event(const trace_kind, const uint32_t pid = 0,
+                   const int64_t value = 0, const uint32_t other = 0);
+  // Write the recorded events to out
+  void dump_trace();
+  /* Timeline, when there is one: p starts state at t, CPU i starts
+  state for p at t, and the counters as they are now.*/
+  void show_state(process_ptr p, const timeline_state state,
+                  const sim_time t) {
+    if (timeline != NULL) {
+      timeline->process_state(p - processes.begin(), state, p->get_ID(), t);
+    }
+  };
+  void show_cpu(const uint32_t i, const timeline_state state, process_ptr p,
+                const sim_time t) {
+    if (timeline != NULL) {
+      timeline->cpu_state(i, state, p->get_ID(), t);
+    }
+  };
+  void show_counts() {
+    if (timeline != NULL) {
+      timeline->count(time, ready_processes(), blocked.size());
+    }
+  };
+  // End the timeline with the run
+  void finish_timeline() {
+    if (timeline != NULL) {
+      timeline->finish(time);
+    }
+  };
+  // Number of processes in the ready queues, for the timeline
+  virtual size_t ready_processes() const { return ready_queue->size(); };
   virtual void perform_add_to_ready_queue() = 0;
+  // The workload simulated, shared with other simulators
+  std::shared_ptr<const workload> jobs;
+  // State of each process in this run, in ID order
   std::vector<process> processes;
+  // Where the overview and event log go. May be NULL
+  std::ostream *out;
+  const std::string name;
+  event_trace trace;
+  // Scratch space for the ready queue of a traced event
+  std::vector<process_ptr> trace_queue;
   const int t_cs;
-  int time;
+  std::shared_ptr<const switch_cost> switch_costs;
+  // Estimates the bursts for SJF and SRT, NULL for the other policies
+  std::unique_ptr<burst_predictor> predictor;
+  /* The ready queue by the actual remaining time of the processes, to
+  score the dispatches against. Only kept with a predictor.*/
+  std::unique_ptr<indexed_heap_queue> shortest;
+  std::unique_ptr<timeline_writer> timeline;
+  sim_time time;
+  /* Whether the run has started, the state of the running process where
+  it stopped (-2 for an idle CPU) and the time at which it stops early
+  (see run_until).*/
+  bool started;
+  int cpu_state;
+  sim_time pause_at;
   process_ptr running;
-  std::list<process_ptr> ready_queue;
-  std::set<process_ptr> blocked;
-  std::set<process_ptr> terminated;
+  // Process that was switched out last, processes.end() before any
+  process_ptr last_out;
+  // Time each process last stopped running, -1 before it ran
+  std::vector<sim_time> stopped;
+  sim_time switch_time;
+  // Positions of the processes ordered by arrival time, ties by ID
+  std::vector<uint32_t> arrival_order;
+  // First entry of arrival_order that has not arrived before now
+  size_t next_arrival;
+  // The process at entry i of arrival_order
+  process_ptr arrival(const size_t i) {
+    return processes.begin() + arrival_order[i];
+  };
+  std::unique_ptr<process_queue> ready_queue;
+  /* Wait is accounted from timestamps instead of every ms: wait_clock
+  counts the ms the ready queue has waited, and a process has waited
+  wait_clock - enqueued[p] ms when it leaves the queue.*/
+  sim_time wait_clock;
+  std::vector<sim_time> enqueued;
+  // Time the running process got the CPU, for its turnaround
+  sim_time dispatched;
+  // Processes blocked on I/O, keyed by the I/O tick they complete on
+  io_timer blocked;
+  // Number of ms that processes have spent on I/O so far
+  sim_time io_clock;
+  /* Processes whose I/O completed in this tick. This and pre_ready_queue
+  only hold the few processes that become ready in one tick, so they keep
+  the handles the policies take instead of indices.*/
+  std::vector<process_ptr> woken;
+  size_t n_terminated;
   std::vector<process_ptr> pre_ready_queue;
+  // Latency of the bursts of one process
+  struct process_latency {
+    // The current burst so far
+    sim_time wait;
+    sim_time turnaround;
+    bool responded;
+    // The completed bursts
+    int bursts;
+    sim_time total_wait;
+    sim_time max_wait;
+    sim_time total_turnaround;
+    sim_time max_turnaround;
+    sim_time total_response;
+    sim_time max_response;
+  };
+  std::vector<process_latency> latency;
+  // Latency of all completed bursts
+  latency_histogram wait_histogram;
+  latency_histogram turnaround_histogram;
+  latency_histogram response_histogram;
   // variables for stats
   double wait_time;
   double n_wait;
   double turnaround_time;
   int n_cs;
   int n_preemption;
+  /* Streamed runs only: where the processes come from, the slots that
+  hold no live process, the bursts of the process in each slot, and the
+  next process of the stream, read ahead for its arrival time.*/
+  std::unique_ptr<process_stream> stream;
+  std::vector<process_ptr> free_slots;
+  std::vector<std::vector<int>> slot_bursts;
+  bool stream_ahead;
+  int ahead_arrival;
+  std::vector<int> ahead_bursts;
+  // Processes taken from the stream so far, and their CPU bursts
+  uint32_t n_streamed;
+  int64_t streamed_CPU_time;
+  int64_t streamed_CPU_bursts;
+  std::ostream *retired;
+  const char *stream_error;
 };
 
 class FCFS_scheduling : public schedule_algorithm {
 public:
   // Constructor. New arrival added to beggining when add is true
   // end when false
-  FCFS_scheduling(const std::vector<process> &p, const int t_cs);
+  FCFS_scheduling(std::shared_ptr<const workload> p, const int t_cs);
   void run();
 
-private:
+protected:
   void perform_add_to_ready_queue();
+  bool save_policy(snapshot_writer &) const { return true; };
+  bool restore_policy(snapshot_reader &) { return true; };
 };
 
 class RR_scheduling : public schedule_algorithm {
 public:
   // Constructor. New arrival added to beggining when add is true
   // end when false
-  RR_scheduling(const std::vector<process> &p, const int t_cs,
+  RR_scheduling(std::shared_ptr<const workload> p, const int t_cs,
                 const int t_slice, const bool add);
   void run();
 
-private:
+protected:
   void perform_add_to_ready_queue();
+  bool save_policy(snapshot_writer &) const;
+  bool restore_policy(snapshot_reader &);
+
+private:
   // time slice value
   int t_slice;
   // New arrival is added to begginning when add is true
   bool add;
+  // The time the current process is running for
+  int time_running;
 };
 
 class SJF_scheduling : public schedule_algorithm {
 public:
   // Constructor. New arrival added to beggining when add is true
   // end when false
-  SJF_scheduling(const std::vector<process> &p, const int t_cs,
+  SJF_scheduling(std::shared_ptr<const workload> p, const int t_cs,
                  const double lambda, const double alpha);
   void run();
 
-private:
+protected:
   void perform_add_to_ready_queue();
-  // update the est_tau
-  int est_tau(double tau, int t);
-  // lamida for calculate tau0;
-  double lambda;
-  // alpha is a parameter in the equation
-  double alpha;
+  // The estimates themselves are kept with the processes
+  bool save_policy(snapshot_writer &w) const {
+    predictor->save(w);
+    return true;
+  };
+  bool restore_policy(snapshot_reader &r) { return predictor->restore(r); };
 };
 
 class SRT_scheduling : public schedule_algorithm {
 public:
-  SRT_scheduling(const std::vector<process> &p, const int t_cs,
+  SRT_scheduling(std::shared_ptr<const workload> p, const int t_cs,
                  const double lambda, const double alpha);
   void run();
 
-private:
+protected:
   void perform_add_to_ready_queue();
-  // update the est_tau
-  int est_tau(double tau, int t);
+  bool save_policy(snapshot_writer &w) const {
+    predictor->save(w);
+    return true;
+  };
+  bool restore_policy(snapshot_reader &);
+
+private:
   // Check preemption in pre_ready_queue
   process_ptr check_preemption();
   // Check a multiple preemption after context switch
   void ready_queue_preemption();
-  // lamida for calculate tau0;
-  double lambda;
-  // alpha is a parameter in the equation
-  double alpha;
   //
   process_ptr preempting_process;
 };
 
+/* Multi-level feedback queue. A process arrives on the first level and
+runs for at most the quantum of its level before the next process of the
+highest non-empty level gets the CPU. Once it has used up the quantum of
+its level, counted over all its bursts, it moves down a level. A process
+becoming ready on a higher level than the running one preempts it. Every
+boost ms all processes move back to the first level.*/
+class MLFQ_scheduling : public schedule_algorithm {
+public:
+  MLFQ_scheduling(std::shared_ptr<const workload> p, const int t_cs,
+                  const std::vector<int> &quanta, const int boost);
+  void run();
+
+protected:
+  void perform_add_to_ready_queue();
+
+private:
+  // ms the running process may still run before its quantum is used up
+  const sim_time quantum_left() const;
+  // Move every process back to the first level
+  void priority_boost();
+  // The ready queue, seen as levels
+  multilevel_queue *levels;
+  std::vector<int> quanta;
+  int boost;
+  sim_time next_boost;
+  // ms each process has run on its current level
+  std::vector<int> used;
+};
+
+/* Completely fair scheduling, after Linux. The ready queue is ordered by
+virtual runtime: the time a process has run, scaled by 1024 / its weight
+(1024 for nice 0, the Linux weights otherwise). The first process runs
+for its share, by weight, of a period of latency ms, or granularity ms per
+runnable process when there are more than latency / granularity. A new
+process starts at the least virtual runtime of the runnable processes,
+and one back from I/O is credited at most latency / 2 ms for its sleep. A
+process becoming ready with granularity ms less virtual runtime than the
+running one preempts it.*/
+class CFS_scheduling : public schedule_algorithm {
+public:
+  CFS_scheduling(std::shared_ptr<const workload> p, const int t_cs,
+                 const int latency, const int granularity,
+                 const std::vector<int> &nice);
+  void run();
+
+protected:
+  void perform_add_to_ready_queue();
+
+private:
+  // Switch to process_in, or to nothing, and start its slice
+  void switch_to(process_ptr process_in);
+  /* Add ms of running to the virtual runtime of the running process. A
+  charge of n ms comes to the same as n charges of 1 ms.*/
+  void charge(const sim_time ms);
+  // Move min_vruntime up to the least virtual runtime of the runnable
+  void update_min_vruntime();
+  // Length of the time slice of the running process
+  const sim_time slice() const;
+  // Target latency and minimum granularity in ms
+  const int latency;
+  const int granularity;
+  std::vector<int> weight;
+  // Virtual runtime of each process, in us of a nice 0 process
+  std::vector<int64_t> vruntime;
+  // Virtual runtime charged short of a whole us, in 1 / weight us
+  std::vector<int64_t> vruntime_rest;
+  // Never decreases, so that placing processes at it is fair
+  int64_t min_vruntime;
+  // Total weight of the processes in the ready queue
+  int64_t queued_weight;
+  // Slice of the running process and how much of it it has run
+  sim_time slice_length;
+  sim_time time_running;
+  // A process became ready that should preempt the running one
+  bool wakeup_preempt;
+};
+
+/* What stride and lottery scheduling share. Every process holds tickets
+and is entitled to a share of the CPU in proportion to them, among the
+processes that are ready or running at the time. The running process
+runs for t_slice ms, after which the policy decides whether another one
+gets the CPU. write_stats also reports the CPU time each process got
+against the time it was entitled to.*/
+class share_scheduling : public schedule_algorithm {
+public:
+  share_scheduling(std::shared_ptr<const workload> p, const int t_cs,
+                   const std::string &name, const int t_slice,
+                   const std::vector<int> &tickets);
+  void run();
+  void write_stats(std::ofstream &);
+
+protected:
+  void perform_add_to_ready_queue();
+  // Process p starts a burst, after arriving or completing I/O
+  virtual void joined(process_ptr) {}
+  // The running process has run for ms more
+  virtual void ran(const sim_time) {}
+  /* The slice of the running process is over and the ready queue is not
+  empty. Returns whether the head of the ready queue gets the CPU.*/
+  virtual bool take_turn() = 0;
+  std::vector<int> tickets;
+
+private:
+  // Account ms of running of the running process
+  void charge(const sim_time ms);
+  // p becomes ready or stops being ready or running for its burst
+  void join(process_ptr);
+  void leave(process_ptr);
+  const int t_slice;
+  sim_time time_running;
+  /* CPU time each ticket was entitled to so far: the ms run divided by
+  the tickets of the processes ready or running during each of them.*/
+  double ticket_clock;
+  int64_t active_tickets;
+  // ticket_clock when each process last became ready
+  std::vector<double> joined_at;
+  // CPU time each process was entitled to and got so far
+  std::vector<double> entitled;
+  std::vector<sim_time> received;
+};
+
+/* Stride scheduling. The stride of a process is inversely proportional
+to its tickets, and its pass advances by its stride for every ms it
+runs. The ready queue is a heap ordered by pass; at the end of a slice
+the process with the lowest pass gets the CPU if it is lower than the
+running one's. A process starting a burst has its pass moved up to the
+lowest pass of the ready and running processes, so it cannot save up
+CPU time while blocked.*/
+class stride_scheduling : public share_scheduling {
+public:
+  stride_scheduling(std::shared_ptr<const workload> p, const int t_cs,
+                    const int t_slice, const std::vector<int> &tickets);
+
+protected:
+  void joined(process_ptr);
+  void ran(const sim_time ms);
+  bool take_turn();
+
+private:
+  std::vector<int64_t> stride;
+  std::vector<int64_t> pass;
+  // Never decreases
+  int64_t global_pass;
+};
+
+/* Lottery scheduling. At the end of a slice a ticket of the ready and
+running processes is drawn at random, and its holder gets the CPU.*/
+class lottery_scheduling : public share_scheduling {
+public:
+  lottery_scheduling(std::shared_ptr<const workload> p, const int t_cs,
+                     const int t_slice, const std::vector<int> &tickets,
+                     const int seed);
+
+protected:
+  bool take_turn();
+
+private:
+  // The ready queue, which does the draws
+  lottery_queue *lottery;
+};
+
+// Orderings of the ready queues, ties broken by ID
+bool resolveTie(process_ptr, process_ptr);
+bool ShorterJobTime(process_ptr, process_ptr);
+bool ShorterRemainingTime(process_ptr, process_ptr);
+// By the actual remaining time of the current burst, for scoring only
+bool ShorterActualTime(process_ptr, process_ptr);
+
+// The switch cost model of the parameters, NULL for t_cs / 2 per half
+std::shared_ptr<const switch_cost>
+make_switch_cost(const schedule_parameters &parameters);
+
+/* The burst predictor of the parameters for n processes, NULL for an
+unknown one.*/
+std::unique_ptr<burst_predictor>
+make_predictor(const schedule_parameters &parameters, const uint32_t n);
+
+/* Build the simulator called name ("SJF", "SRT", "FCFS", "RR", "MLFQ",
+"CFS", "STRIDE" or "LOTTERY") over the processes, on parameters.cores
+cores if that is above 0. Returns NULL for an unknown name or a policy
+without a multi-core version (all but the first four).*/
+schedule_algorithm *make_scheduler(const std::string &name,
+                                   std::shared_ptr<const workload>,
+                                   const schedule_parameters &);
+
+/* Build the simulator called name for a streamed run of the processes of
+s, at most slots of them live at once, with the latency line of each
+written to retired as it terminates. Only SJF, SRT, FCFS and RR on a
+single CPU can be streamed; returns NULL for the others.*/
+schedule_algorithm *
+make_streamed_scheduler(const std::string &name,
+                        std::unique_ptr<process_stream> s,
+                        const uint32_t slots, std::ostream *retired,
+                        const schedule_parameters &parameters);
+
 #endif
@@ -0,0 +1,69 @@
+/* Checkpoints of a simulation (see schedule_algorithm::save): a compact
+binary image of its state, in the byte order and layout of the machine
+that wrote it, to be read back by the same build. snapshot_writer appends
+plain values and vectors of them, and snapshot_reader reads them back in
+the same order, failing from the first read past the end on.
+ */
+#ifndef SNAPSHOT
+#define SNAPSHOT
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+class snapshot_writer {
+public:
+  snapshot_writer(std::vector<char> &out) : out(out) {}
+  template <class T> void put(const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+    const char *bytes = (const char *)&value;
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+  };
+  // The size, then the values
+  template <class T> void put_vector(const std::vector<T> &values) {
+    static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+    put<uint64_t>(values.size());
+    const char *bytes = (const char *)values.data();
+    out.insert(out.end(), bytes, bytes + sizeof(T) * values.size());
+  };
+
+private:
+  std::vector<char> &out;
+};
+
+class snapshot_reader {
+public:
+  snapshot_reader(const std::vector<char> &in) : in(in), at(0), ok(true) {}
+  // Returns false, and keeps returning false, once the snapshot runs out
+  template <class T> bool get(T &value) {
+    static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+    ok = ok && in.size() - at >= sizeof(T);
+    if (ok) {
+      memcpy((void *)&value, in.data() + at, sizeof(T));
+      at += sizeof(T);
+    }
+    return ok;
+  };
+  template <class T> bool get_vector(std::vector<T> &values) {
+    uint64_t size;
+    if (!get(size) || size > (in.size() - at) / sizeof(T)) {
+      ok = false;
+      return false;
+    }
+    values.resize(size);
+    memcpy((void *)values.data(), in.data() + at, sizeof(T) * size);
+    at += sizeof(T) * size;
+    return true;
+  };
+  // Whether everything was read without running out
+  const bool good() const { return ok; };
+  const bool at_end() const { return at == in.size(); };
+
+private:
+  const std::vector<char> &in;
+  size_t at;
+  bool ok;
+};
+
+#endif
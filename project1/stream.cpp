@@ -0,0 +1,24 @@
+#include "stream.h"
+#include "workload.h"
+
+text_stream::text_stream(const std::string &path)
+    : file(path), last_arrival(0) {
+  if (!file) {
+    error = "cannot be read";
+  }
+}
+
+bool text_stream::next(int &arrival_time, std::vector<int> &bursts) {
+  while (error == NULL && std::getline(file, line)) {
+    const int parsed = workload::parse_line(line, arrival_time, bursts);
+    if (parsed < 0) {
+      error = "is not a valid text workload";
+    } else if (parsed > 0 && arrival_time < last_arrival) {
+      error = "is not in arrival order";
+    } else if (parsed > 0) {
+      last_arrival = arrival_time;
+      return true;
+    }
+  }
+  return false;
+}
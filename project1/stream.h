@@ -0,0 +1,40 @@
+/* Processes read one at a time, in arrival order, for runs too long to
+hold their whole workload (see workload.h) in memory. A streamed run only
+keeps the processes that have arrived and not terminated yet, so its
+memory follows the number of live processes rather than the total.
+ */
+#ifndef STREAM
+#define STREAM
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class process_stream {
+public:
+  virtual ~process_stream() {}
+  /* Read the next process, which gets the next ID: its arrival time, no
+  earlier than the one before, and its bursts as in workload::add.
+  Returns false at the end of the stream or on an error.*/
+  virtual bool next(int &arrival_time, std::vector<int> &bursts) = 0;
+  // Why the stream ended early, NULL if it did not
+  const char *get_error() const { return error; };
+
+protected:
+  process_stream() : error(NULL) {}
+  const char *error;
+};
+
+// A workload file in the text format, with its processes in arrival order
+class text_stream : public process_stream {
+public:
+  text_stream(const std::string &path);
+  bool next(int &arrival_time, std::vector<int> &bursts);
+
+private:
+  std::ifstream file;
+  std::string line;
+  int last_arrival;
+};
+
+#endif
@@ -0,0 +1,245 @@
+#include "sweep.h"
+#include "generator.h"
+#include "schedule_algorithm.h"
+#include "thread_pool.h"
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+// Parse "a,b,c", "first:last:step" or "first:last" (step 1) into values
+static bool parse_values(const char *text, std::vector<double> &values) {
+  double first, last, step = 1;
+  char extra;
+  if (sscanf(text, "%lf:%lf:%lf%c", &first, &last, &step, &extra) == 3 ||
+      sscanf(text, "%lf:%lf%c", &first, &last, &extra) == 2) {
+    if (step <= 0 || last < first) {
+      return false;
+    }
+    for (long k = 0; first + k * step <= last + step * 1e-9; ++k) {
+      /* Round trip through text, so that 0.01 + 6 * 0.01 becomes the same
+      0.07 that the command line would give */
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "%.12g", first + k * step);
+      values.push_back(atof(buffer));
+    }
+    return true;
+  }
+  std::stringstream list(text);
+  std::string item;
+  while (std::getline(list, item, ',')) {
+    char *end;
+    values.push_back(strtod(item.c_str(), &end));
+    if (item.empty() || *end != '\0') {
+      return false;
+    }
+  }
+  return !values.empty();
+}
+
+// Parse "BEGINNING,END" into values
+static bool parse_rr_add(const char *text, std::vector<double> &values) {
+  std::stringstream list(text);
+  std::string item;
+  while (std::getline(list, item, ',')) {
+    if (item == "END") {
+      values.push_back(0);
+    } else if (item == "BEGINNING") {
+      values.push_back(1);
+    } else {
+      return false;
+    }
+  }
+  return !values.empty();
+}
+
+bool run_sweep(const std::vector<const char *> &args,
+               const std::vector<std::string> &algorithms,
+               const unsigned int threads, const generator_kind generator,
+               const schedule_parameters &machine, const sim_time warmup,
+               std::ostream &out) {
+  if (args.size() < 8 || args.size() > 9) {
+    return false;
+  }
+  /* Values of each axis in the order of the positional arguments: seed,
+  lambda, upper bound, n, t_cs, alpha, t_slice, rr_add. The first four
+  decide the workload.*/
+  const int n_axes = 8;
+  std::vector<double> axes[n_axes];
+  for (int i = 0; i < 7; ++i) {
+    if (!parse_values(args[i + 1], axes[i])) {
+      return false;
+    }
+  }
+  if (args.size() == 9) {
+    if (!parse_rr_add(args[8], axes[7])) {
+      return false;
+    }
+  } else {
+    axes[7].push_back(0);
+  }
+  for (auto i : axes[3]) {
+    if (i <= 0) {
+      return false;
+    }
+  }
+  for (auto i : axes[4]) {
+    if (i <= 0 || (int)i % 2 != 0) {
+      return false;
+    }
+  }
+
+  // Index of a point along each axis, the last axis changing fastest
+  size_t n_points = 1;
+  for (int i = 0; i < n_axes; ++i) {
+    n_points *= axes[i].size();
+  }
+  const size_t n_workloads =
+      axes[0].size() * axes[1].size() * axes[2].size() * axes[3].size();
+  auto coordinates = [&axes](size_t point, int axis) {
+    for (int i = n_axes - 1; i > axis; --i) {
+      point /= axes[i].size();
+    }
+    return point % axes[axis].size();
+  };
+
+  thread_pool pool(threads);
+  // Generate each workload once; the points that use it share it
+  std::vector<std::shared_ptr<const workload>> workloads(n_workloads);
+  for (size_t w = 0; w < n_workloads; ++w) {
+    pool.submit([&, w] {
+      const size_t point = w * (n_points / n_workloads);
+      const int s = axes[0][coordinates(point, 0)];
+      const double lambda = axes[1][coordinates(point, 1)];
+      const int threshold = axes[2][coordinates(point, 2)];
+      const int n = axes[3][coordinates(point, 3)];
+      // Workloads are already generated in parallel with each other
+      workloads[w] = std::make_shared<workload>(
+          generator == DRAND48_GENERATOR
+              ? process_generator(s, lambda, threshold, n)
+              : counter_generator(s, lambda, threshold, n, 1));
+    });
+  }
+  pool.wait();
+
+  // Warm up each algorithm on each workload once; the points fork it
+  auto point_parameters = [&](size_t point) {
+    schedule_parameters parameters = machine;
+    parameters.lottery_seed = axes[0][coordinates(point, 0)];
+    parameters.lambda = axes[1][coordinates(point, 1)];
+    parameters.t_cs = axes[4][coordinates(point, 4)];
+    parameters.alpha = axes[5][coordinates(point, 5)];
+    parameters.t_slice = axes[6][coordinates(point, 6)];
+    parameters.rr_add = axes[7][coordinates(point, 7)];
+    return parameters;
+  };
+  std::vector<std::unique_ptr<schedule_algorithm>> warmed;
+  if (warmup > 0) {
+    warmed.resize(n_workloads * algorithms.size());
+    for (size_t w = 0; w < n_workloads; ++w) {
+      for (size_t a = 0; a < algorithms.size(); ++a) {
+        pool.submit([&, w, a] {
+          const size_t point = w * (n_points / n_workloads);
+          schedule_algorithm *simulator =
+              make_scheduler(algorithms[a], workloads[w],
+                             point_parameters(point));
+          simulator->set_output(NULL);
+          simulator->run_until(warmup);
+          warmed[w * algorithms.size() + a].reset(simulator);
+        });
+      }
+    }
+    pool.wait();
+  }
+
+  // Switch time is only worth a column when switches are not all t_cs
+  const bool costed = make_switch_cost(machine) != NULL;
+  const char *names[n_axes] = {"seed", "lambda", "upper_bound", "n",
+                               "t_cs", "alpha",  "t_slice",     "rr_add"};
+  for (int i = 0; i < n_axes; ++i) {
+    out << (i ? "," : "") << names[i];
+  }
+  const char *latencies[3] = {"wait", "turnaround", "response"};
+  const char *percentiles[5] = {"p50", "p90", "p99", "p99.9", "max"};
+  for (auto &i : algorithms) {
+    out << "," << i << "_burst_time," << i << "_wait_time," << i
+        << "_turnaround_time," << i << "_context_switches," << i
+        << "_preemptions";
+    for (auto l : latencies) {
+      for (auto p : percentiles) {
+        out << "," << i << "_" << l << "_" << p;
+      }
+    }
+    if (machine.cores > 0) {
+      out << "," << i << "_utilization," << i << "_migrations";
+    }
+    if (costed) {
+      out << "," << i << "_switch_time";
+    }
+    if (!machine.predictor.empty() && (i == "SJF" || i == "SRT")) {
+      out << "," << i << "_prediction_error," << i << "_prediction_bias,"
+          << i << "_misordered";
+    }
+  }
+  out << "\n";
+
+  // Rows finish in any order but are written in grid order
+  std::vector<std::string> rows(n_points);
+  std::vector<bool> done(n_points, false);
+  size_t next_row = 0;
+  std::mutex rows_lock;
+  for (size_t point = 0; point < n_points; ++point) {
+    pool.submit([&, point] {
+      const schedule_parameters parameters = point_parameters(point);
+      std::ostringstream row;
+      for (int i = 0; i < n_axes - 1; ++i) {
+        row << (i ? "," : "") << axes[i][coordinates(point, i)];
+      }
+      row << "," << (parameters.rr_add ? "BEGINNING" : "END");
+      row << std::setprecision(3) << std::fixed;
+      const size_t w = point / (n_points / n_workloads);
+      for (size_t a = 0; a < algorithms.size(); ++a) {
+        // Forks only read the warmed up simulator
+        std::unique_ptr<schedule_algorithm> simulator(
+            warmup > 0
+                ? warmed[w * algorithms.size() + a]->fork(parameters)
+                : make_scheduler(algorithms[a], workloads[w], parameters));
+        simulator->set_output(NULL);
+        simulator->run();
+        const schedule_stats stats = simulator->get_stats();
+        row << "," << stats.average_burst_time << ","
+            << stats.average_wait_time << "," << stats.average_turnaround_time
+            << "," << stats.context_switches << "," << stats.preemptions;
+        for (auto l : {&stats.wait, &stats.turnaround, &stats.response}) {
+          row << "," << l->p50 << "," << l->p90 << "," << l->p99 << ","
+              << l->p999 << "," << l->max;
+        }
+        if (machine.cores > 0) {
+          row << "," << stats.utilization << "," << stats.migrations;
+        }
+        if (costed) {
+          row << "," << stats.switch_time;
+        }
+        if (!machine.predictor.empty() &&
+            (algorithms[a] == "SJF" || algorithms[a] == "SRT")) {
+          row << "," << stats.prediction_error << "," << stats.prediction_bias
+              << "," << stats.misordered;
+        }
+      }
+      row << "\n";
+      std::lock_guard<std::mutex> guard(rows_lock);
+      rows[point] = row.str();
+      done[point] = true;
+      while (next_row < n_points && done[next_row]) {
+        out << rows[next_row];
+        rows[next_row].clear();
+        ++next_row;
+      }
+    });
+  }
+  pool.wait();
+  out.flush();
+  return true;
+}
@@ -0,0 +1,36 @@
+/* Parameter sweeps over the simulators. Every positional argument of
+./main can be a comma separated list "a,b,c" or an inclusive range
+"first:last:step" ("first:last" counts in steps of 1), and every
+combination of them is simulated.
+ */
+#ifndef SWEEP
+#define SWEEP
+
+#include "generator.h"
+#include "schedule_algorithm.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* Run the sweep described by the positional arguments args (args[0] is
+the program name) for the given algorithms on the given number of threads,
+with workloads from the given generator, and write one CSV row per point
+to out, in grid order. Every row has what write_stats reports of each
+algorithm, the latency percentiles included. The machine (cores, migration cost and balance) and
+the switch cost model are taken from machine, and a modelled switch cost
+adds each algorithm's time spent switching to the row, as a burst
+predictor given in machine adds how good the estimates of SJF and SRT
+were. Returns false if the arguments cannot be parsed.
+
+With a warmup above 0, each algorithm simulates the first warmup ms of a
+workload once, with the parameters of the workload's first point, and
+every point of the workload carries on from a fork of it (see
+schedule_algorithm::fork). Only SJF, SRT, FCFS and RR on a single CPU can
+be warmed up.*/
+bool run_sweep(const std::vector<const char *> &args,
+               const std::vector<std::string> &algorithms,
+               const unsigned int threads, const generator_kind generator,
+               const schedule_parameters &machine, const sim_time warmup,
+               std::ostream &out);
+
+#endif
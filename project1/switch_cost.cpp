@@ -0,0 +1,16 @@
+#include "switch_cost.h"
+#include <math.h>
+
+cache_switch_cost::cache_switch_cost(const int t_cs, const int resume,
+                                     const int penalty, const int decay)
+    : half(t_cs / 2), resume(resume), penalty(penalty), decay(decay) {}
+
+int cache_switch_cost::in(const sim_time idle, const bool same) const {
+  if (same) {
+    return resume;
+  }
+  if (idle < 0 || decay <= 0) {
+    return half + penalty;
+  }
+  return half + (int)ceil(penalty * (1 - exp(-(double)idle / decay)));
+}
@@ -0,0 +1,52 @@
+/* How long a context switch takes. Every switch has two halves, the
+running process being switched out and the next one being switched in,
+and the simulators ask the model for the length of each half as it
+starts. A half takes at least 1 ms.
+ */
+#ifndef SWITCH_COST
+#define SWITCH_COST
+
+#include "process.h"
+
+class switch_cost {
+public:
+  virtual ~switch_cost() {}
+  // Ms to switch out the running process
+  virtual int out() const = 0;
+  /* Ms to switch in a process that left the CPU idle ms ago (-1 if it
+  never ran). same is true when no other process ran in between, so its
+  state is still on the CPU.*/
+  virtual int in(const sim_time idle, const bool same) const = 0;
+};
+
+// t_cs / 2 for each half, whatever is switched
+class fixed_switch_cost : public switch_cost {
+public:
+  fixed_switch_cost(const int t_cs) : half(t_cs / 2) {}
+  int out() const { return half; };
+  int in(const sim_time, const bool) const { return half; };
+
+private:
+  const int half;
+};
+
+/* t_cs / 2 to switch out. Switching in the process that ran last costs
+resume ms; any other process costs t_cs / 2 plus a cache and TLB warmth
+penalty of up to penalty ms, which grows with the time since the process
+last ran as penalty * (1 - exp(-idle / decay)). A process that never ran
+pays all of it.*/
+class cache_switch_cost : public switch_cost {
+public:
+  cache_switch_cost(const int t_cs, const int resume, const int penalty,
+                    const int decay);
+  int out() const { return half; };
+  int in(const sim_time idle, const bool same) const;
+
+private:
+  const int half;
+  const int resume;
+  const int penalty;
+  const int decay;
+};
+
+#endif
@@ -0,0 +1,24 @@
+#! /bin/sh
+# Tracing must not change the schedules: build with the event trace
+# compiled in, run every algorithm with and without --trace=2 and check
+# that simout.txt comes out the same
+
+set -e
+src=$(pwd)
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+g++ -Wall -Werror -std=c++17 -O2 -pthread -DSCHED_TRACE -o "$dir/main" \
+	$(ls "$src"/*.cpp | grep -v bench.cpp)
+cd "$dir"
+args="2 0.01 3000 64 4 0.5 120 --ids=numbers"
+args="$args --algorithms=SJF,SRT,FCFS,RR,MLFQ,CFS,STRIDE,LOTTERY"
+./main $args > /dev/null
+mv simout.txt untraced.txt
+./main $args --trace=2 > /dev/null
+mv simout.txt traced.txt
+if ! cmp -s untraced.txt traced.txt; then
+	echo "FAIL: --trace changes the simulation"
+	diff untraced.txt traced.txt | head -20
+	exit 1
+fi
+echo "PASS: --trace leaves the simulation as it is"
@@ -0,0 +1,92 @@
+#include "thread_pool.h"
+
+thread_pool::thread_pool(unsigned int n)
+    : next_queue(0), unclaimed(0), unfinished(0), stopping(false) {
+  if (n == 0) {
+    n = std::thread::hardware_concurrency();
+  }
+  if (n == 0) {
+    n = 1;
+  }
+  for (unsigned int i = 0; i < n; ++i) {
+    queues.emplace_back(new task_queue);
+  }
+  for (unsigned int i = 0; i < n; ++i) {
+    workers.emplace_back(&thread_pool::work, this, i);
+  }
+}
+
+thread_pool::~thread_pool() {
+  wait();
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  task_ready.notify_all();
+  for (auto &i : workers) {
+    i.join();
+  }
+}
+
+void thread_pool::submit(std::function<void()> task) {
+  task_queue &queue = *queues[next_queue++ % queues.size()];
+  {
+    std::lock_guard<std::mutex> guard(queue.lock);
+    queue.tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    ++unclaimed;
+    ++unfinished;
+  }
+  task_ready.notify_one();
+}
+
+void thread_pool::wait() {
+  std::unique_lock<std::mutex> guard(lock);
+  all_done.wait(guard, [this] { return unfinished == 0; });
+}
+
+bool thread_pool::take(const unsigned int i, std::function<void()> &task) {
+  for (unsigned int k = 0; k < queues.size(); ++k) {
+    task_queue &queue = *queues[(i + k) % queues.size()];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    if (k == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    return true;
+  }
+  return false;
+}
+
+void thread_pool::work(const unsigned int i) {
+  while (true) {
+    {
+      // Claim one of the queued tasks, or stop if there are none left
+      std::unique_lock<std::mutex> guard(lock);
+      task_ready.wait(guard, [this] { return stopping || unclaimed > 0; });
+      if (unclaimed == 0) {
+        return;
+      }
+      --unclaimed;
+    }
+    /* A task is put in its queue before it is counted, so the claimed
+    one is there to be found, though another worker may get to it first
+    and leave a different one.*/
+    std::function<void()> task;
+    while (!take(i, task)) {
+    }
+    task();
+    std::lock_guard<std::mutex> guard(lock);
+    if (--unfinished == 0) {
+      all_done.notify_all();
+    }
+  }
+}
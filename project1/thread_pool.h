@@ -0,0 +1,55 @@
+/* A fixed set of worker threads running submitted tasks. Every worker
+has its own task queue; tasks are dealt out to the queues in turn, and a
+worker whose queue runs dry steals the oldest task of another worker.
+ */
+#ifndef THREAD_POOL
+#define THREAD_POOL
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class thread_pool {
+public:
+  // Start n worker threads. 0 means one per hardware thread
+  thread_pool(unsigned int n = 0);
+  // Waits for the submitted tasks, then stops the workers
+  ~thread_pool();
+  // Queue a task to run on one of the workers
+  void submit(std::function<void()>);
+  // Block until every submitted task has finished
+  void wait();
+  const unsigned int size() const { return workers.size(); };
+
+private:
+  struct task_queue {
+    std::mutex lock;
+    std::deque<std::function<void()>> tasks;
+  };
+  // Loop of worker i: take a task, run it, repeat until stopped
+  void work(const unsigned int i);
+  /* Take a task for worker i: the newest one of its own queue, or else
+  the oldest one of another queue. Returns false if all are empty.*/
+  bool take(const unsigned int i, std::function<void()> &);
+  std::vector<std::thread> workers;
+  std::vector<std::unique_ptr<task_queue>> queues;
+  // Queue the next submitted task goes to
+  unsigned int next_queue;
+  // Guards the counters below
+  std::mutex lock;
+  // Signalled when a task is queued or the pool stops
+  std::condition_variable task_ready;
+  // Signalled when the last unfinished task is done
+  std::condition_variable all_done;
+  // Tasks queued that no worker has claimed yet
+  unsigned int unclaimed;
+  // Tasks submitted but not finished yet
+  unsigned int unfinished;
+  bool stopping;
+};
+
+#endif
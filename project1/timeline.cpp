@@ -0,0 +1,183 @@
+#include "timeline.h"
+#include <charconv>
+
+// Trace process groups of the CPU and the process tracks
+static const int CPU_GROUP = 1;
+static const int PROCESS_GROUP = 2;
+// Events are short, so the buffer is written out this close to full
+static const size_t buffer_size = 1 << 20;
+static const size_t buffer_slack = 512;
+
+const char *timeline_writer::state_names[TIMELINE_STATES] = {
+    "idle", "ready", "switch in", "running", "switch out", "I/O"};
+
+timeline_writer::timeline_writer(std::ostream &out, const std::string &name)
+    : out(out), ready(-1), blocked(-1), first_event(true), finished(false) {
+  buffer.reserve(buffer_size);
+  append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  const int groups[2] = {CPU_GROUP, PROCESS_GROUP};
+  const char *suffixes[2] = {" CPUs", " processes"};
+  for (int i = 0; i < 2; ++i) {
+    begin_event();
+    append("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":");
+    append((int64_t)groups[i]);
+    append(",\"args\":{\"name\":\"");
+    append(name);
+    append(suffixes[i]);
+    append("\"}}");
+  }
+}
+
+timeline_writer::~timeline_writer() { flush(true); }
+
+void timeline_writer::cpu_state(const uint32_t i, const timeline_state state,
+                                const uint32_t pid, const sim_time t) {
+  if (i >= cpus.size()) {
+    cpus.resize(i + 1, track{0, 0, TIMELINE_IDLE, false});
+  }
+  track &cpu = cpus[i];
+  if (!cpu.named) {
+    write_name(CPU_GROUP, i, "CPU " + std::to_string(i));
+    cpu.named = true;
+  }
+  set_state(cpu, CPU_GROUP, i, state, pid, t);
+}
+
+void timeline_writer::process_state(const uint32_t i,
+                                    const timeline_state state,
+                                    const uint32_t pid, const sim_time t) {
+  if (i >= processes.size()) {
+    processes.resize(i + 1, track{0, 0, TIMELINE_IDLE, false});
+  }
+  track &p = processes[i];
+  // Streamed runs put another process in the slot once one terminates
+  if (!p.named || p.pid != pid) {
+    set_state(p, PROCESS_GROUP, p.pid, TIMELINE_IDLE, p.pid, t);
+    write_name(PROCESS_GROUP, pid, "Process " + process::name(pid));
+    p.named = true;
+    p.pid = pid;
+  }
+  set_state(p, PROCESS_GROUP, pid, state, pid, t);
+}
+
+void timeline_writer::count(const sim_time t, const size_t ready,
+                            const size_t blocked) {
+  if ((int64_t)ready != this->ready) {
+    write_counter("ready queue", t, ready);
+    this->ready = ready;
+  }
+  if ((int64_t)blocked != this->blocked) {
+    write_counter("blocked on I/O", t, blocked);
+    this->blocked = blocked;
+  }
+}
+
+void timeline_writer::finish(const sim_time t) {
+  if (finished) {
+    return;
+  }
+  for (uint32_t i = 0; i < cpus.size(); ++i) {
+    set_state(cpus[i], CPU_GROUP, i, TIMELINE_IDLE, cpus[i].pid, t);
+  }
+  for (auto &p : processes) {
+    set_state(p, PROCESS_GROUP, p.pid, TIMELINE_IDLE, p.pid, t);
+  }
+  append("\n]}\n");
+  flush(true);
+  out.flush();
+  finished = true;
+}
+
+void timeline_writer::set_state(track &tr, const int group, const uint32_t tid,
+                                const timeline_state state, const uint32_t pid,
+                                const sim_time t) {
+  if (tr.state == state && tr.pid == pid) {
+    return;
+  }
+  if (tr.state != TIMELINE_IDLE && t > tr.since) {
+    write_slice(tr, group, tid, t);
+  }
+  tr.state = state;
+  tr.pid = pid;
+  tr.since = t;
+}
+
+void timeline_writer::write_slice(const track &tr, const int group,
+                                  const uint32_t tid, const sim_time t) {
+  begin_event();
+  append("{\"name\":\"");
+  // The CPUs show the process, the processes what they were doing
+  if (group == CPU_GROUP) {
+    append(process::name(tr.pid));
+    if (tr.state != TIMELINE_RUNNING) {
+      append(" (");
+      append(state_names[tr.state]);
+      append(")");
+    }
+  } else {
+    append(state_names[tr.state]);
+  }
+  append("\",\"cat\":\"");
+  append(state_names[tr.state]);
+  append("\",\"ph\":\"X\",\"ts\":");
+  append(tr.since * 1000);
+  append(",\"dur\":");
+  append((t - tr.since) * 1000);
+  append(",\"pid\":");
+  append((int64_t)group);
+  append(",\"tid\":");
+  append((int64_t)tid);
+  append("}");
+  flush();
+}
+
+void timeline_writer::write_name(const int group, const uint32_t tid,
+                                 const std::string &name) {
+  begin_event();
+  append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":");
+  append((int64_t)group);
+  append(",\"tid\":");
+  append((int64_t)tid);
+  append(",\"args\":{\"name\":\"");
+  append(name);
+  append("\"}}");
+  flush();
+}
+
+void timeline_writer::write_counter(const char *name, const sim_time t,
+                                    const size_t value) {
+  begin_event();
+  append("{\"name\":\"");
+  append(name);
+  append("\",\"ph\":\"C\",\"ts\":");
+  append(t * 1000);
+  append(",\"pid\":");
+  append((int64_t)CPU_GROUP);
+  append(",\"args\":{\"processes\":");
+  append((int64_t)value);
+  append("}}");
+  flush();
+}
+
+void timeline_writer::begin_event() {
+  if (!first_event) {
+    append(",\n");
+  }
+  first_event = false;
+}
+
+void timeline_writer::append(const char *text) { buffer += text; }
+
+void timeline_writer::append(const int64_t value) {
+  char digits[24];
+  const std::to_chars_result end =
+      std::to_chars(digits, digits + sizeof(digits), value);
+  buffer.append(digits, end.ptr - digits);
+}
+
+void timeline_writer::flush(const bool all) {
+  if (all || buffer.size() + buffer_slack >= buffer_size) {
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+  }
+}
@@ -0,0 +1,91 @@
+/* Timeline of a simulation in the Chrome trace event format (JSON), which
+ui.perfetto.dev and chrome://tracing open. It has a track for every CPU,
+showing which process it was running or switching, one for every
+process, showing whether it was ready, switching, running or on I/O, and
+counters of the processes in the ready queues and blocked on I/O. The
+CPUs are grouped under one trace process and the simulated processes
+under another; simulated ms show as ms.
+
+Every track goes from one state to the next, and a state is written out
+when the next one on its track starts, so only the open state of each
+track is kept. Events are formatted into a large buffer that is written
+out when full, which keeps millions of them down to seconds.
+ */
+#ifndef TIMELINE
+#define TIMELINE
+
+#include "process.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum timeline_state : uint8_t {
+  // Not shown: a CPU with nothing on it, a process before it arrives or
+  // after it terminates
+  TIMELINE_IDLE,
+  TIMELINE_READY,
+  TIMELINE_SWITCH_IN,
+  TIMELINE_RUNNING,
+  TIMELINE_SWITCH_OUT,
+  TIMELINE_IO,
+  TIMELINE_STATES
+};
+
+class timeline_writer {
+public:
+  // Write the timeline of the simulator called name to out
+  timeline_writer(std::ostream &out, const std::string &name);
+  // Writes out the buffer, not the end of the trace (see finish)
+  ~timeline_writer();
+  /* CPU i starts state for the process with ID pid at time t, and the
+  process in slot i (its position in the process vector) the same. States
+  must start in time order on each track.*/
+  void cpu_state(const uint32_t i, const timeline_state state,
+                 const uint32_t pid, const sim_time t);
+  void process_state(const uint32_t i, const timeline_state state,
+                     const uint32_t pid, const sim_time t);
+  // The counters at time t. Only changes are written
+  void count(const sim_time t, const size_t ready, const size_t blocked);
+  /* End every state at t and close the trace. Nothing is written
+  afterwards.*/
+  void finish(const sim_time t);
+
+private:
+  struct track {
+    sim_time since;
+    uint32_t pid;
+    timeline_state state;
+    bool named;
+  };
+  // Start state on track, which is in trace process group, at t
+  void set_state(track &, const int group, const uint32_t tid,
+                 const timeline_state state, const uint32_t pid,
+                 const sim_time t);
+  // Write the state that track has been in since then up to t
+  void write_slice(const track &, const int group, const uint32_t tid,
+                   const sim_time t);
+  // The name of the thread tid of group
+  void write_name(const int group, const uint32_t tid,
+                  const std::string &name);
+  void write_counter(const char *name, const sim_time t, const size_t value);
+  // Start an event
+  void begin_event();
+  void append(const char *text);
+  void append(const std::string &text) { buffer += text; };
+  void append(const int64_t value);
+  // Write the buffer to out if it is nearly full, or if all is true
+  void flush(const bool all = false);
+  static const char *state_names[TIMELINE_STATES];
+  std::ostream &out;
+  std::string buffer;
+  std::vector<track> cpus;
+  std::vector<track> processes;
+  // Counters last written, -1 for none yet
+  int64_t ready;
+  int64_t blocked;
+  bool first_event;
+  bool finished;
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "trace.h"
+
+#ifdef SCHED_TRACE
+const bool event_trace::compiled_in = true;
+#else
+const bool event_trace::compiled_in = false;
+#endif
+
+const int event_trace::levels[TRACE_KINDS] = {1, 1, 1, 1, 1, 1, 1, 1, 2,
+                                              2, 2, 2, 2, 2, 2, 2, 2, 2, 2};
+
+event_trace::event_trace() : level(0), n_records(0), n_queue_ids(0) {}
+
+void event_trace::set_level(const int level, const size_t records,
+                            const size_t queue_ids) {
+  this->level = level;
+  n_records = 0;
+  n_queue_ids = 0;
+  // Nothing is allocated unless something is going to be kept
+  this->records.assign(level > 0 ? records : 0, trace_record());
+  this->queue_ids.assign(level > 0 ? queue_ids : 0, 0);
+}
+
+void event_trace::record(const trace_record &r,
+                         const std::vector<process_ptr> &queue) {
+  if (records.empty()) {
+    return;
+  }
+  trace_record &slot = records[n_records % records.size()];
+  slot = r;
+  slot.queue = n_queue_ids;
+  slot.queue_length = queue.size();
+  for (auto i : queue) {
+    queue_ids[n_queue_ids % queue_ids.size()] = i->get_ID();
+    ++n_queue_ids;
+  }
+  ++n_records;
+}
+
+void event_trace::dump(std::ostream &out, const std::string &algorithm) {
+  const uint64_t first =
+      n_records > records.size() ? n_records - records.size() : 0;
+  if (first > 0) {
+    out << "(" << first << " earlier events not kept)\n";
+  }
+  for (uint64_t n = first; n < n_records; ++n) {
+    const trace_record &r = records[n % records.size()];
+    const std::string name = process::name(r.pid);
+    out << "time " << r.time << "ms: ";
+    switch (r.kind) {
+    case TRACE_START:
+      out << "Simulator started for " << algorithm;
+      break;
+    case TRACE_END:
+      out << "Simulator ended for " << algorithm;
+      break;
+    case TRACE_ARRIVAL:
+      out << "Process " << name << " arrived; added to ready queue";
+      break;
+    case TRACE_IO_DONE:
+      out << "Process " << name << " completed I/O; added to ready queue";
+      break;
+    case TRACE_ARRIVAL_TAU:
+      out << "Process " << name << " (tau " << r.value
+          << "ms) arrived; added to ready queue";
+      break;
+    case TRACE_IO_DONE_TAU:
+      out << "Process " << name << " (tau " << r.value
+          << "ms) completed I/O; added to ready queue";
+      break;
+    case TRACE_BURST_DONE:
+      out << "Process " << name << " completed a CPU burst; " << r.value
+          << (r.value > 1 ? " bursts " : " burst ") << "to go";
+      break;
+    case TRACE_TERMINATED:
+      out << "Process " << name << " terminated";
+      break;
+    case TRACE_TAU:
+      out << "Recalculated tau = " << r.value << "ms for process " << name;
+      break;
+    case TRACE_BLOCK:
+      out << "Process " << name
+          << " switching out of CPU; will block on I/O until time " << r.value
+          << "ms";
+      break;
+    case TRACE_START_BURST:
+      out << "Process " << name << " started using the CPU for " << r.value
+          << "ms burst";
+      break;
+    case TRACE_RESUME:
+      out << "Process " << name << " started using the CPU with " << r.value
+          << "ms remaining";
+      break;
+    case TRACE_SLICE_PREEMPT:
+      out << "Time slice expired; process " << name << " preempted with "
+          << r.value << "ms to go";
+      break;
+    case TRACE_SLICE_NO_PREEMPT:
+      out << "Time slice expired; no preemption because ready queue is empty";
+      break;
+    case TRACE_PREEMPT:
+      out << "Process " << name << " (tau " << r.value << "ms) will preempt "
+          << process::name(r.other);
+      break;
+    case TRACE_IO_PREEMPT:
+      out << "Process " << name << " (tau " << r.value
+          << "ms) completed I/O and will preempt " << process::name(r.other);
+      break;
+    case TRACE_SLICE_KEEP:
+      out << "Time slice expired; process " << name
+          << " keeps the CPU for another slice";
+      break;
+    case TRACE_VRUNTIME_PREEMPT:
+      out << "Process " << name << " (vruntime " << r.value
+          << "ms) will preempt " << process::name(r.other);
+      break;
+    case TRACE_LEVEL_PREEMPT:
+      out << "Process " << name << " (level " << r.value << ") will preempt "
+          << process::name(r.other);
+      break;
+    default:
+      break;
+    }
+    out << " [Q";
+    if (n_queue_ids - r.queue > queue_ids.size()) {
+      // Overwritten by later snapshots
+      out << " <lost>";
+    } else {
+      for (uint64_t i = r.queue; i < r.queue + r.queue_length; ++i) {
+        out << " " << process::name(queue_ids[i % queue_ids.size()]);
+      }
+      if (r.queue_length == 0)
+        out << " <empty>";
+    }
+    out << "]\n";
+  }
+  n_records = 0;
+  n_queue_ids = 0;
+}
@@ -0,0 +1,90 @@
+/* Event trace of a simulation. Events are kept as fixed size records in
+a ring buffer, together with the IDs of the processes in the ready queue
+at that moment, and only turned into text when the trace is dumped.
+Build with -DSCHED_TRACE (make TRACE=1) to compile the TRACE_EVENT call
+sites in; without it they cost nothing. With it, set_level() picks which
+events are kept at run time, 0 (the default) keeping none.
+ */
+#ifndef EVENT_TRACE
+#define EVENT_TRACE
+
+#include "process.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum trace_kind : uint8_t {
+  // Level 1
+  TRACE_START,            // Simulator started
+  TRACE_END,              // Simulator ended
+  TRACE_ARRIVAL,          // pid arrived
+  TRACE_IO_DONE,          // pid completed I/O
+  TRACE_ARRIVAL_TAU,      // pid with tau value arrived
+  TRACE_IO_DONE_TAU,      // pid with tau value completed I/O
+  TRACE_BURST_DONE,       // pid completed a burst, value bursts to go
+  TRACE_TERMINATED,       // pid terminated
+  // Level 2
+  TRACE_TAU,              // tau of pid recalculated to value
+  TRACE_BLOCK,            // pid switching out, blocked until time value
+  TRACE_START_BURST,      // pid started a burst of value ms
+  TRACE_RESUME,           // pid resumed with value ms to go
+  TRACE_SLICE_PREEMPT,    // pid preempted by RR with value ms to go
+  TRACE_SLICE_NO_PREEMPT,
+  TRACE_PREEMPT,          // pid with tau value will preempt other
+  TRACE_IO_PREEMPT,       // pid with tau value completed I/O, preempts other
+  TRACE_LEVEL_PREEMPT,    // pid on MLFQ level value will preempt other
+  TRACE_VRUNTIME_PREEMPT, // pid with vruntime value ms will preempt other
+  TRACE_SLICE_KEEP,       // pid keeps the CPU for another slice
+  TRACE_KINDS
+};
+
+struct trace_record {
+  sim_time time;
+  int64_t value;
+  // Position of the queue snapshot in the ID ring
+  uint64_t queue;
+  uint32_t queue_length;
+  uint32_t pid;
+  uint32_t other;
+  trace_kind kind;
+};
+
+class event_trace {
+public:
+  event_trace();
+  // Whether the TRACE_EVENT call sites are compiled in
+  static const bool compiled_in;
+  /* Keep the events up to level (0 for none) in rings of records events
+  and queue_ids process IDs. The oldest ones are overwritten.*/
+  void set_level(const int level, const size_t records = 1 << 18,
+                 const size_t queue_ids = 1 << 22);
+  const int get_level() const { return level; };
+  bool wants(const trace_kind kind) const { return level >= levels[kind]; };
+  void record(const trace_record &, const std::vector<process_ptr> &queue);
+  // Write the kept events in the old event log format and forget them
+  void dump(std::ostream &, const std::string &algorithm);
+
+private:
+  static const int levels[TRACE_KINDS];
+  int level;
+  std::vector<trace_record> records;
+  std::vector<uint32_t> queue_ids;
+  // Number of records and IDs written so far
+  uint64_t n_records;
+  uint64_t n_queue_ids;
+};
+
+#ifdef SCHED_TRACE
+#define TRACE_EVENT(kind, ...)                                                 \
+  do {                                                                         \
+    if (trace.wants(kind))                                                     \
+      trace_event(kind, ##__VA_ARGS__);                                        \
+  } while (0)
+#else
+#define TRACE_EVENT(kind, ...)                                                 \
+  do {                                                                         \
+  } while (0)
+#endif
+
+#endif
@@ -0,0 +1,281 @@
+#include "workload.h"
+#include <assert.h>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Start of a binary workload file
+struct workload_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t n_processes;
+  uint32_t unused;
+  uint64_t n_bursts;
+  int64_t CPU_time;
+  int64_t n_CPU_bursts;
+};
+
+static const char workload_magic[8] = {'C', 'P', 'U', 'S', 'I', 'M', 'W', 'L'};
+static const uint32_t workload_version = 1;
+static const uint32_t workload_byte_order = 0x01020304;
+
+workload::workload()
+    : table(NULL), bursts(NULL), n_processes(0), CPU_time(0),
+      n_CPU_bursts(0), mapping(NULL), mapping_size(0) {}
+
+workload::workload(workload &&w) : mapping(NULL) { *this = std::move(w); }
+
+workload &workload::operator=(workload &&w) {
+  unmap();
+  entries = std::move(w.entries);
+  burst_store = std::move(w.burst_store);
+  table = w.table;
+  bursts = w.bursts;
+  n_processes = w.n_processes;
+  CPU_time = w.CPU_time;
+  n_CPU_bursts = w.n_CPU_bursts;
+  mapping = w.mapping;
+  mapping_size = w.mapping_size;
+  if (mapping == NULL) {
+    use_storage();
+  }
+  // w gives up the mapping and is left empty
+  w.mapping = NULL;
+  w.entries.clear();
+  w.burst_store.clear();
+  w.use_storage();
+  w.n_processes = 0;
+  w.CPU_time = 0;
+  w.n_CPU_bursts = 0;
+  return *this;
+}
+
+workload::~workload() { unmap(); }
+
+void workload::add(const int arrival_time, const int *bursts,
+                   const uint32_t n_bursts) {
+  // Size must be odd. Since first and last bursts are CPU
+  assert(n_bursts % 2);
+  // A mapped workload is read-only
+  assert(mapping == NULL);
+  entry e;
+  e.arrival_time = arrival_time;
+  e.n_bursts = n_bursts;
+  e.offset = burst_store.size();
+  entries.push_back(e);
+  burst_store.insert(burst_store.end(), bursts, bursts + n_bursts);
+  for (uint32_t i = 0; i < n_bursts; i += 2) {
+    CPU_time += bursts[i];
+    ++n_CPU_bursts;
+  }
+  ++n_processes;
+  use_storage();
+}
+
+void workload::reserve(const uint32_t n, const size_t bursts) {
+  entries.reserve(n);
+  burst_store.reserve(bursts);
+  use_storage();
+}
+
+void workload::layout(const std::vector<int> &arrival_times,
+                      const std::vector<uint32_t> &n_bursts) {
+  assert(arrival_times.size() == n_bursts.size());
+  unmap();
+  entries.resize(arrival_times.size());
+  uint64_t offset = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    assert(n_bursts[i] % 2);
+    entries[i].arrival_time = arrival_times[i];
+    entries[i].n_bursts = n_bursts[i];
+    entries[i].offset = offset;
+    offset += n_bursts[i];
+  }
+  burst_store.assign(offset, 0);
+  n_processes = entries.size();
+  use_storage();
+  count_CPU_time();
+}
+
+void workload::count_CPU_time() {
+  CPU_time = 0;
+  n_CPU_bursts = 0;
+  for (uint32_t i = 0; i < n_processes; ++i) {
+    for (uint32_t j = 0; j < table[i].n_bursts; j += 2) {
+      CPU_time += bursts[table[i].offset + j];
+      ++n_CPU_bursts;
+    }
+  }
+}
+
+bool workload::save(const std::string &path) const {
+  workload_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, workload_magic, sizeof(header.magic));
+  header.version = workload_version;
+  header.byte_order = workload_byte_order;
+  header.n_processes = n_processes;
+  header.n_bursts = 0;
+  if (n_processes > 0) {
+    header.n_bursts = table[n_processes - 1].offset +
+                      table[n_processes - 1].n_bursts;
+  }
+  header.CPU_time = CPU_time;
+  header.n_CPU_bursts = n_CPU_bursts;
+  std::ofstream file(path, std::ios::binary);
+  file.write((const char *)&header, sizeof(header));
+  file.write((const char *)table, sizeof(entry) * n_processes);
+  file.write((const char *)bursts, sizeof(int32_t) * header.n_bursts);
+  file.close();
+  return !file.fail();
+}
+
+bool workload::save_text(const std::string &path) const {
+  std::ofstream file(path);
+  file << "# arrival time, then CPU and I/O bursts in ms\n";
+  for (uint32_t i = 0; i < n_processes; ++i) {
+    file << get_arrival_time(i);
+    for (uint32_t j = 0; j < get_n_bursts(i); ++j) {
+      file << " " << get_bursts(i)[j];
+    }
+    file << "\n";
+  }
+  file.close();
+  return !file.fail();
+}
+
+bool workload::load(const std::string &path) {
+  // Binary files are told apart by their magic
+  char magic[sizeof(workload_magic)] = {0};
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  file.read(magic, sizeof(magic));
+  file.close();
+  if (memcmp(magic, workload_magic, sizeof(magic)) == 0) {
+    return load_binary(path);
+  }
+  return load_text(path);
+}
+
+bool workload::load_binary(const std::string &path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(workload_header)) {
+    close(fd);
+    return false;
+  }
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  const workload_header *header = (const workload_header *)map;
+  const entry *map_table =
+      (const entry *)((const char *)map + sizeof(workload_header));
+  const int32_t *map_bursts = (const int32_t *)(map_table +
+                                                header->n_processes);
+  // Check the layout before trusting any offset in it
+  bool valid = header->version == workload_version &&
+               header->byte_order == workload_byte_order &&
+               (uint64_t)st.st_size ==
+                   sizeof(workload_header) +
+                       sizeof(entry) * (uint64_t)header->n_processes +
+                       sizeof(int32_t) * header->n_bursts;
+  uint64_t offset = 0;
+  for (uint32_t i = 0; valid && i < header->n_processes; ++i) {
+    valid = map_table[i].offset == offset && map_table[i].n_bursts % 2 == 1 &&
+            map_table[i].arrival_time >= 0;
+    offset += map_table[i].n_bursts;
+  }
+  valid = valid && offset == header->n_bursts;
+  // Then what the text format rejects as well
+  for (uint64_t i = 0; valid && i < header->n_bursts; ++i) {
+    valid = map_bursts[i] > 0;
+  }
+  if (!valid) {
+    munmap(map, st.st_size);
+    return false;
+  }
+  unmap();
+  entries.clear();
+  burst_store.clear();
+  mapping = map;
+  mapping_size = st.st_size;
+  table = map_table;
+  bursts = map_bursts;
+  n_processes = header->n_processes;
+  // Not taken from the header, which could disagree with the bursts
+  count_CPU_time();
+  return true;
+}
+
+bool workload::load_text(const std::string &path) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  workload w;
+  std::string line;
+  int arrival_time;
+  std::vector<int> time_sequence;
+  while (std::getline(file, line)) {
+    const int parsed = parse_line(line, arrival_time, time_sequence);
+    if (parsed < 0) {
+      return false;
+    } else if (parsed > 0) {
+      w.add(arrival_time, time_sequence.data(), time_sequence.size());
+    }
+  }
+  *this = std::move(w);
+  return true;
+}
+
+int workload::parse_line(const std::string &line, int &arrival_time,
+                         std::vector<int> &bursts) {
+  std::stringstream fields(line);
+  if (!(fields >> arrival_time)) {
+    // Only empty lines and comments have no arrival time
+    fields.clear();
+    char first;
+    if (fields >> first && first != '#') {
+      return -1;
+    }
+    return 0;
+  }
+  bursts.clear();
+  int burst;
+  while (fields >> burst) {
+    bursts.push_back(burst);
+  }
+  if (!fields.eof() || arrival_time < 0 || bursts.size() % 2 == 0) {
+    return -1;
+  }
+  for (auto i : bursts) {
+    if (i <= 0) {
+      return -1;
+    }
+  }
+  return 1;
+}
+
+void workload::use_storage() {
+  table = entries.data();
+  bursts = burst_store.data();
+}
+
+void workload::unmap() {
+  if (mapping != NULL) {
+    munmap(mapping, mapping_size);
+    mapping = NULL;
+  }
+}
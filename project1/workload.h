@@ -0,0 +1,104 @@
+/* The processes to simulate: arrival times and burst sequences of all
+processes in one contiguous table. A workload is built once, then shared
+read-only by every simulator that runs it, each of which only keeps a
+small process state per process pointing into the table.
+
+Workloads can be saved and loaded in two formats:
+- Binary, read with mmap so that loading does not copy the bursts. In
+  the byte order of the machine that wrote it:
+    header   magic "CPUSIMWL", version, byte order mark 0x01020304,
+             number of processes, number of bursts, CPU time and number
+             of CPU bursts (48 bytes; the last two are recounted when
+             loading)
+    table    per process: arrival time, number of bursts, offset of its
+             first burst (16 bytes each)
+    bursts   all bursts, 4 bytes each
+- Text, for interchange: one process per line, its arrival time followed
+  by its bursts. Empty lines and lines starting with # are skipped.
+Process IDs count up in the order of the file.
+ */
+#ifndef WORKLOAD
+#define WORKLOAD
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class workload {
+public:
+  workload();
+  workload(workload &&);
+  workload &operator=(workload &&);
+  // Shared, never copied
+  workload(const workload &) = delete;
+  ~workload();
+  /* Add the process with the next ID. Its bursts alternate between CPU
+  and I/O, the first and the last being CPU bursts, so n_bursts is odd.*/
+  void add(const int arrival_time, const int *bursts, const uint32_t n_bursts);
+  // Make room for n processes with bursts bursts in total
+  void reserve(const uint32_t n, const size_t bursts);
+  /* Replace the workload by processes with the given arrival times and
+  numbers of bursts. Their bursts are then written through
+  get_bursts_to_fill(), from any thread, and count_CPU_time() is called
+  once all are written.*/
+  void layout(const std::vector<int> &arrival_times,
+              const std::vector<uint32_t> &n_bursts);
+  int *get_bursts_to_fill(const uint32_t i) {
+    return burst_store.data() + entries[i].offset;
+  };
+  void count_CPU_time();
+  const uint32_t size() const { return n_processes; };
+  const int get_arrival_time(const uint32_t i) const {
+    return table[i].arrival_time;
+  };
+  // The bursts of process i, valid as long as the workload is
+  const int *get_bursts(const uint32_t i) const {
+    return bursts + table[i].offset;
+  };
+  const uint32_t get_n_bursts(const uint32_t i) const {
+    return table[i].n_bursts;
+  };
+  // Sum and number of the CPU bursts of all processes
+  const int64_t get_CPU_time() const { return CPU_time; };
+  const int64_t get_n_CPU_bursts() const { return n_CPU_bursts; };
+  /* Write the workload to a file in the binary or the text format.
+  Return false if the file cannot be written.*/
+  bool save(const std::string &path) const;
+  bool save_text(const std::string &path) const;
+  /* Replace the workload by the one in a file, in either format. Return
+  false if the file cannot be read or is not a valid workload, one with
+  a negative arrival time or a burst under 1 ms included.*/
+  bool load(const std::string &path);
+  /* Read one line of the text format into the arrival time and bursts of
+  a process. Returns 1 for a process, 0 for a line to skip and -1 for an
+  invalid line.*/
+  static int parse_line(const std::string &line, int &arrival_time,
+                        std::vector<int> &bursts);
+
+private:
+  struct entry {
+    int32_t arrival_time;
+    uint32_t n_bursts;
+    uint64_t offset;
+  };
+  bool load_binary(const std::string &path);
+  bool load_text(const std::string &path);
+  // Make table and bursts point at the vectors below
+  void use_storage();
+  void unmap();
+  // Storage of a workload built in memory, empty when mapped from a file
+  std::vector<entry> entries;
+  std::vector<int32_t> burst_store;
+  // What the accessors read, either the storage or the mapped file
+  const entry *table;
+  const int32_t *bursts;
+  uint32_t n_processes;
+  int64_t CPU_time;
+  int64_t n_CPU_bursts;
+  // The mapped file, NULL when there is none
+  void *mapping;
+  size_t mapping_size;
+};
+
+#endif